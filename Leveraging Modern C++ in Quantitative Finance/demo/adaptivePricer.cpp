@@ -0,0 +1,43 @@
+#include "qf/BSMOptPricer.hpp"
+#include "qf/MCEuroOptPricer.hpp"
+#include "qf/MCSettings.hpp"
+#include "qf/OptionType.hpp"
+
+#include <cstddef>
+#include <iostream>
+
+auto main() -> int {
+  const Real S = 100.0;
+  const Real r = 0.05;
+  const Real vol = 0.2;
+  const Real T = 1.0;
+  const std::size_t m = 1;
+  const std::size_t n = 4000000;
+  const int seed = 0;
+
+  MCSettings fixed{.pathScheme = PathScheme::Exact, .controlVariate = true};
+  MCSettings adaptive{.pathScheme = PathScheme::Exact,
+                      .controlVariate = true,
+                      .targetStandardError = 0.002};
+
+  // calls from deep in the money to far out of it: the same standard error
+  // takes far fewer paths away from the money
+  Real fixedTime = 0.0;
+  Real adaptiveTime = 0.0;
+  std::size_t adaptivePaths = 0;
+  for (Real K = 40.0; K <= 200.0; K += 20.0) {
+    MCEuroOptPricer x(S, K, r, vol, T, OptionType::Call, m, n, true, seed, 1.0,
+                      fixed);
+    MCEuroOptPricer y(S, K, r, vol, T, OptionType::Call, m, n, true, seed, 1.0,
+                      adaptive);
+    BSMOptPricer z(S, K, r, vol, T, OptionType::Call, 1.0);
+    fixedTime += x.time();
+    adaptiveTime += y.time();
+    adaptivePaths += y.numScenariosRun();
+    std::cout << K << '\t' << y() << " +/- " << y.standardError() << " ("
+              << y.numScenariosRun() << " paths)\t" << z() << '\n';
+  }
+  std::cout << "fixed " << n << " paths per option: " << fixedTime << "ms\n";
+  std::cout << "adaptive, " << adaptivePaths << " paths in all: "
+            << adaptiveTime << "ms\n";
+}
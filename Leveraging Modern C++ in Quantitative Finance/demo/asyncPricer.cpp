@@ -0,0 +1,66 @@
+#include "qf/AsyncPricing.hpp"
+#include "qf/BSMOptPricer.hpp"
+#include "qf/EuroTree.hpp"
+#include "qf/MCEuroOptPricer.hpp"
+#include "qf/MCSettings.hpp"
+#include "qf/OptionType.hpp"
+
+#include <cstddef>
+#include <iostream>
+#include <stop_token>
+
+auto main() -> int {
+  const Real S = 100.0;
+  const Real K = 100.0;
+  const Real r = 0.05;
+  const Real vol = 0.2;
+  const Real T = 1.0;
+  const std::size_t m = 252;
+  const std::size_t n = 400000;
+  const int seed = 0;
+  const MCSettings settings{.controlVariate = true, .batchSize = 100000};
+
+  // three requests in flight at once; the Monte-Carlo one reports its
+  // estimate after every batch
+  auto bsm = priceAsync([=](const PricingControl &control) {
+    return BSMOptPricer(S, K, r, vol, T, OptionType::Put, 1.0, control);
+  });
+  auto tree = priceAsync([=](const PricingControl &control) {
+    return EuroTree(S, r, vol, 0.0, K, T, OptionType::Put, 2000, {},
+                    control);
+  });
+  auto mc = priceAsync(
+      [=](const PricingControl &control) {
+        return MCEuroOptPricer(S, K, r, vol, T, OptionType::Put, m, n, true,
+                               seed, 1.0, settings, control);
+      },
+      {},
+      [](const PricingProgress &progress) {
+        std::cout << "  " << 100 * progress.fraction << "%: "
+                  << progress.estimate << " +/- " << progress.standardError
+                  << '\n';
+      });
+  const Real mcPrice = mc.get()();
+  std::cout << "Monte-Carlo " << mcPrice << '\n';
+  std::cout << "tree " << tree.get().optionPrice() << '\n';
+  std::cout << "closed form " << bsm.get()() << '\n';
+
+  // a request abandoned halfway, as when the market data ticks
+  std::stop_source source;
+  auto stale = priceAsync(
+      [=](const PricingControl &control) {
+        return MCEuroOptPricer(S, K, r, vol, T, OptionType::Put, m, 100 * n,
+                               true, seed, 1.0, settings, control);
+      },
+      source.get_token(),
+      [&source](const PricingProgress &progress) {
+        if (progress.fraction >= 0.01) {
+          source.request_stop();
+        }
+      });
+  try {
+    std::cout << stale.get()() << '\n';
+  } catch (const PricingCancelled &e) {
+    std::cout << e.what() << '\n';
+  }
+}
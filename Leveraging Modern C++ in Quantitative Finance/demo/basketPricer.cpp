@@ -0,0 +1,39 @@
+#include "qf/MCBasketOptPricer.hpp"
+#include "qf/OptionType.hpp"
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+auto main() -> int {
+  const std::size_t numAssets = 20;
+  const Real r = 0.05;
+  const Real T = 1.0;
+  const std::size_t m = 52;
+  const std::size_t n = 10000;
+  const int seed = 0;
+  const Real q = 1.0;
+
+  // equally weighted basket of 20 names, pairwise correlation 0.4
+  std::vector<Real> spots(numAssets, 100.0);
+  std::vector<Real> vols(numAssets, 0.25);
+  std::vector<Real> correlation(numAssets * numAssets, 0.4);
+  for (std::size_t i = 0; i != numAssets; ++i) {
+    correlation[i * numAssets + i] = 1.0;
+  }
+  std::vector<Real> weights(numAssets, 1.0 / numAssets);
+
+  MCBasketOptPricer basket(spots, vols, correlation, r, T,
+                           {weights, 100.0, OptionType::Call}, m, n, true,
+                           seed, q, {.controlVariate = true});
+  std::cout << "Basket call: " << basket() << " +/- "
+            << basket.standardError() << ' ' << basket.time() << "ms\n";
+
+  // spread between the first two names, drawn exactly at expiry
+  MCBasketOptPricer spread(spots, vols, correlation, r, T,
+                           spreadPayoff(numAssets, 0, 1, 5.0, OptionType::Call),
+                           m, n, true, seed, q,
+                           {.pathScheme = PathScheme::Exact});
+  std::cout << "Spread call: " << spread() << " +/- "
+            << spread.standardError() << '\n';
+}
@@ -0,0 +1,111 @@
+#include "qf/BSMKernel.hpp"
+#include "qf/BSMOptPricer.hpp"
+#include "qf/OptionType.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <span>
+#include <vector>
+
+auto main() -> int {
+  // a day's worth of listed options, drawn at random
+  const std::size_t n = 5000000;
+  std::vector<Real> spots(n);
+  std::vector<Real> strikes(n);
+  std::vector<Real> rates(n);
+  std::vector<Real> vols(n);
+  std::vector<Real> expiries(n);
+  std::vector<OptionType> types(n);
+  std::mt19937_64 engine(0);
+  std::uniform_real_distribution<Real> unit;
+  for (std::size_t i = 0; i != n; ++i) {
+    spots[i] = 100.0;
+    strikes[i] = 50.0 + 100.0 * unit(engine);
+    rates[i] = 0.05 * unit(engine);
+    vols[i] = 0.05 + 0.75 * unit(engine);
+    expiries[i] = 0.01 + 3.0 * unit(engine);
+    types[i] = unit(engine) < 0.5 ? OptionType::Call : OptionType::Put;
+  }
+
+  auto ms = [](auto b, auto e) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(e - b)
+        .count();
+  };
+
+  std::vector<Real> reference(n);
+  auto b = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i != n; ++i) {
+    reference[i] = BSMOptPricer(spots[i], strikes[i], rates[i], vols[i],
+                                expiries[i], types[i], 1.0)();
+  }
+  auto e = std::chrono::steady_clock::now();
+  std::cout << "one BSMOptPricer per option: " << ms(b, e) << "ms\n";
+
+  BSMBatch batch{spots, strikes, rates, vols, expiries, types};
+  std::vector<Real> prices(n);
+  for (bool runParallel : {false, true}) {
+    b = std::chrono::steady_clock::now();
+    bsmPrices(batch, prices, runParallel);
+    e = std::chrono::steady_clock::now();
+    std::cout << "bsmPrices, " << (runParallel ? "parallel" : "one thread")
+              << ": " << ms(b, e) << "ms\n";
+  }
+
+  Real maxError = 0.0;
+  for (std::size_t i = 0; i != n; ++i) {
+    maxError = std::max(maxError, std::abs(prices[i] - reference[i]));
+  }
+  std::cout << "largest difference: " << maxError << '\n';
+
+  // full Greeks on every option, one object at a time and in one batch
+  std::vector<Real> deltas(n);
+  b = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i != n; ++i) {
+    deltas[i] = BSMOptPricer(spots[i], strikes[i], rates[i], vols[i],
+                             expiries[i], types[i], 1.0)
+                    .calcGreeks()
+                    .delta;
+  }
+  e = std::chrono::steady_clock::now();
+  std::cout << "BSMOptPricer::calcGreeks per option: " << ms(b, e) << "ms\n";
+
+  std::vector<Real> gammas(n);
+  std::vector<Real> vegas(n);
+  std::vector<Real> thetas(n);
+  std::vector<Real> rhos(n);
+  BSMGreekSpans greeks{prices, deltas, gammas, vegas, thetas, rhos};
+  b = std::chrono::steady_clock::now();
+  bsmGreeks(batch, greeks, false);
+  e = std::chrono::steady_clock::now();
+  std::cout << "bsmGreeks, one thread: " << ms(b, e) << "ms\n";
+
+  // no volatility or no time left: the discounted intrinsic value, with
+  // finite Greeks, at the money and on either side of it
+  const std::vector<Real> flatSpots{100.0, 100.0, 100.0};
+  const std::vector<Real> flatStrikes{100.0, 90.0, 110.0};
+  const std::vector<Real> flatRates{0.0, 0.05, 0.05};
+  const std::vector<Real> flatVols{0.0, 0.0, 0.2};
+  const std::vector<Real> flatExpiries{1.0, 1.0, 0.0};
+  const std::vector<OptionType> flatTypes{OptionType::Call, OptionType::Call,
+                                          OptionType::Put};
+  std::vector<Real> flat(3 * 6);
+  BSMGreekSpans flatGreeks{
+      std::span(flat).subspan(0, 3),  std::span(flat).subspan(3, 3),
+      std::span(flat).subspan(6, 3),  std::span(flat).subspan(9, 3),
+      std::span(flat).subspan(12, 3), std::span(flat).subspan(15, 3)};
+  bsmGreeks({flatSpots, flatStrikes, flatRates, flatVols, flatExpiries,
+             flatTypes},
+            flatGreeks, false);
+  for (std::size_t i = 0; i != 3; ++i) {
+    std::cout << "vol " << flatVols[i] << ", expiry " << flatExpiries[i]
+              << ", strike " << flatStrikes[i] << ": price "
+              << flatGreeks.prices[i] << ", delta " << flatGreeks.deltas[i]
+              << ", gamma " << flatGreeks.gammas[i] << ", vega "
+              << flatGreeks.vegas[i] << ", theta " << flatGreeks.thetas[i]
+              << ", rho " << flatGreeks.rhos[i] << '\n';
+  }
+}
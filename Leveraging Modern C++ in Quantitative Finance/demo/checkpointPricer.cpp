@@ -0,0 +1,33 @@
+#include "qf/MCEuroOptPricer.hpp"
+#include "qf/MCSettings.hpp"
+#include "qf/OptionType.hpp"
+
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+
+// A long run saving its state every 100000 scenarios:
+//   checkpointPricer run.ckpt
+// Kill it and run the same command again: it resumes from the last
+// checkpoint and prints the result of an uninterrupted run, which is what
+// checkpointPricer prints without a file. Remove the file to start over.
+auto main(int argc, char *argv[]) -> int {
+  const Real S = 100.0;
+  const Real K = 100.0;
+  const Real r = 0.05;
+  const Real vol = 0.2;
+  const Real T = 1.0;
+  const std::size_t m = 252;
+  const std::size_t n = 4000000;
+  const int seed = 0;
+
+  MCSettings settings{.controlVariate = true, .checkpointInterval = 100000};
+  if (argc > 1) {
+    settings.checkpointFile = argv[1];
+  }
+
+  MCEuroOptPricer x(S, K, r, vol, T, OptionType::Put, m, n, true, seed, 1.0,
+                    settings);
+  std::cout << std::setprecision(17) << x() << " +/- " << x.standardError()
+            << " (" << x.time() << "ms)\n";
+}
@@ -4,6 +4,7 @@
 #include <boost/math/differentiation/finite_difference.hpp>
 #include <boost/math/quadrature/trapezoidal.hpp>
 #include <iostream>
+#include <memory>
 
 auto main() -> int {
 
@@ -0,0 +1,124 @@
+#include "qf/BSMKernel.hpp"
+#include "qf/BSMOptPricer.hpp"
+#include "qf/Bisection.hpp"
+#include "qf/OptionType.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+using qf::root_finder::bisection;
+
+auto main() -> int {
+  // a vol surface of 40 expiries by 250 strikes of calls and puts, with a skew
+  // and a smile, priced from its own volatilities
+  const std::size_t numExpiries = 40;
+  const std::size_t numStrikes = 250;
+  const Real spot = 100.0;
+  const Real rate = 0.03;
+  const Real dividend = 0.01;
+  std::vector<Real> spots;
+  std::vector<Real> strikes;
+  std::vector<Real> rates;
+  std::vector<Real> dividends;
+  std::vector<Real> vols;
+  std::vector<Real> expiries;
+  std::vector<OptionType> types;
+  for (std::size_t t = 0; t != numExpiries; ++t) {
+    const Real expiry = 0.02 + 0.05 * static_cast<Real>(t);
+    for (std::size_t k = 0; k != numStrikes; ++k) {
+      const Real strike = 50.0 + 0.4 * static_cast<Real>(k);
+      const Real moneyness = std::log(strike / spot) / std::sqrt(expiry);
+      const Real vol = 0.2 - 0.05 * moneyness + 0.03 * moneyness * moneyness;
+      for (OptionType type : {OptionType::Call, OptionType::Put}) {
+        spots.push_back(spot);
+        strikes.push_back(strike);
+        rates.push_back(rate);
+        dividends.push_back(dividend);
+        vols.push_back(std::min(vol, 2.0));
+        expiries.push_back(expiry);
+        types.push_back(type);
+      }
+    }
+  }
+  const std::size_t n = spots.size();
+  std::vector<Real> prices(n);
+  std::vector<Real> vegas(n);
+  std::vector<Real> unused(n);
+  bsmGreeks({spots, strikes, rates, vols, expiries, types, dividends},
+            {prices, unused, unused, vegas, unused, unused});
+
+  auto ms = [](auto b, auto e) {
+    return std::chrono::duration<double, std::milli>(e - b).count();
+  };
+  // largest volatility error over the quotes with a vega above 1e-4, and how
+  // many have no volatility at all: deep in or out of the money, the rounding
+  // of the price swamps its dependence on the volatility
+  auto report = [&](const char *method, double time,
+                    const std::vector<Real> &implied) {
+    Real maxError = 0.0;
+    std::size_t unsolved = 0;
+    for (std::size_t i = 0; i != n; ++i) {
+      if (std::isnan(implied[i])) {
+        ++unsolved;
+      } else if (vegas[i] > 1e-4) {
+        maxError = std::max(maxError, std::abs(implied[i] - vols[i]));
+      }
+    }
+    std::cout << method << ": " << time << "ms, largest error " << maxError
+              << ", " << unsolved << " of " << n << " without a volatility\n";
+  };
+
+  // one bisection on BSMOptPricer per quote
+  std::vector<Real> implied(n);
+  auto b = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i != n; ++i) {
+    auto f = [&](Real vol) {
+      return BSMOptPricer(spots[i], strikes[i], rates[i], dividends[i], vol,
+                          expiries[i], types[i], 1.0)() -
+             prices[i];
+    };
+    const Real vol = bisection(f, minImpliedVol, maxImpliedVol, 1e-12);
+    implied[i] =
+        std::isfinite(vol) ? vol : std::numeric_limits<Real>::quiet_NaN();
+  }
+  auto e = std::chrono::steady_clock::now();
+  report("bisection per quote", ms(b, e), implied);
+
+  b = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i != n; ++i) {
+    implied[i] = BSMOptPricer::impliedVolatility(prices[i], spots[i],
+                                                 strikes[i], rates[i],
+                                                 dividends[i], expiries[i],
+                                                 types[i]);
+  }
+  e = std::chrono::steady_clock::now();
+  report("BSMOptPricer::impliedVolatility per quote", ms(b, e), implied);
+
+  const BSMBatch quotes{spots, strikes, rates, {}, expiries, types, dividends};
+  for (bool runParallel : {false, true}) {
+    b = std::chrono::steady_clock::now();
+    bsmImpliedVols(quotes, prices, implied, runParallel);
+    e = std::chrono::steady_clock::now();
+    report(runParallel ? "bsmImpliedVols, parallel"
+                       : "bsmImpliedVols, one thread",
+           ms(b, e), implied);
+  }
+
+  // after a tick of the spot, the surface is re-solved from the last one
+  std::vector<Real> ticked(n, spot * 1.001);
+  std::vector<Real> tickedPrices(n);
+  bsmPrices({ticked, strikes, rates, vols, expiries, types, dividends},
+            tickedPrices);
+  const std::vector<Real> last = implied;
+  b = std::chrono::steady_clock::now();
+  bsmImpliedVols({ticked, strikes, rates, last, expiries, types, dividends},
+                 tickedPrices, implied, false);
+  e = std::chrono::steady_clock::now();
+  report("bsmImpliedVols from the last surface, one thread", ms(b, e),
+         implied);
+}
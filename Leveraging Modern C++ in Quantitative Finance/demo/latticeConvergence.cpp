@@ -0,0 +1,71 @@
+#include "qf/BSMOptPricer.hpp"
+#include "qf/EuroTree.hpp"
+#include "qf/OptionType.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+auto main() -> int {
+  // an out of the money call and its in the money put, against Black-Scholes
+  // and, once American, against a tree of 20k steps
+  const Real S = 100.0;
+  const Real r = 0.05;
+  const Real q = 0.02;
+  const Real vol = 0.25;
+  const Real K = 110.0;
+  const Real T = 1.0;
+  const Real european =
+      BSMOptPricer(S, K, r, q, vol, T, OptionType::Call, 1.0)();
+  const Real american =
+      EuroTree(S, r, vol, q, K, T, OptionType::Put, 20002,
+               {.exercise = ExerciseStyle::American,
+                .lattice = LatticeType::LeisenReimer,
+                .richardson = true})
+          .optionPrice();
+
+  auto us = [](auto b, auto e) {
+    return std::chrono::duration<double, std::micro>(e - b).count();
+  };
+  auto report = [&](const char *lattice, LatticeSettings settings,
+                    int numTimePoints) {
+    auto b = std::chrono::steady_clock::now();
+    const Real call =
+        EuroTree(S, r, vol, q, K, T, OptionType::Call, numTimePoints, settings)
+            .optionPrice();
+    settings.exercise = ExerciseStyle::American;
+    const Real put =
+        EuroTree(S, r, vol, q, K, T, OptionType::Put, numTimePoints, settings)
+            .optionPrice();
+    auto e = std::chrono::steady_clock::now();
+    std::cout << lattice << ", " << numTimePoints - 1
+              << " steps: European call off by " << std::abs(call - european)
+              << ", American put by " << std::abs(put - american) << ", "
+              << us(b, e) << "us\n";
+  };
+
+  report("CRR", {}, 1001);
+  report("CRR", {}, 101);
+  report("Tian", {.lattice = LatticeType::Tian}, 101);
+  report("trinomial", {.lattice = LatticeType::Trinomial}, 101);
+  // an odd number of steps, for which it converges smoothly enough to
+  // extrapolate, unlike the other lattices
+  report("Leisen-Reimer", {.lattice = LatticeType::LeisenReimer}, 100);
+  report("Leisen-Reimer, extrapolated",
+         {.lattice = LatticeType::LeisenReimer, .richardson = true}, 100);
+
+  // a tree of 50k steps, one step at a time and as a parallel wavefront of
+  // tiles, which give the same price to the last bit
+  for (bool runParallel : {false, true}) {
+    auto b = std::chrono::steady_clock::now();
+    const Real put = EuroTree(S, r, vol, q, K, T, OptionType::Put, 50001,
+                              {.exercise = ExerciseStyle::American,
+                               .runParallel = runParallel})
+                         .optionPrice();
+    auto e = std::chrono::steady_clock::now();
+    std::cout << "CRR, 50000 steps" << (runParallel ? ", parallel" : "")
+              << ": American put " << std::setprecision(17) << put
+              << std::setprecision(6) << ", " << us(b, e) / 1000.0 << "ms\n";
+  }
+}
@@ -45,7 +45,9 @@ auto main() -> int {
   {
     std::cout << '\n' << "*** Multi Array - Lattice Pricing ***" << '\n';
 
-    EuroTree myTree(100.0, 0.10, 0.2, 0.04, 100.0, 0.5, OptionType::Call, 4);
+    // the nodes are only kept on request
+    EuroTree myTree(100.0, 0.10, 0.2, 0.04, 100.0, 0.5, OptionType::Call, 4,
+                    {.fullGrid = true});
 
     std::cout << '\n'
               << "Display terminal underlying and payoff prices:" << '\n';
@@ -54,6 +56,11 @@ auto main() -> int {
                 << myTree(i, 3).payoff << '\n';
     }
 
+    // the same nodes through a view of the grid, which copies nothing
+    auto grid = myTree.grid();
+    std::cout << "Grid of " << grid.shape()[0] << " by " << grid.shape()[1]
+              << ", root payoff " << grid[0][0].payoff << '\n';
+
     std::cout << '\n' << "Convergence to Black-Scholes-Merton Model:" << '\n';
     EuroTree callTree(100.0, 0.05, 0.2, 0.0, 100.0, 1.0, OptionType::Call,
                       1000);
@@ -63,6 +70,49 @@ auto main() -> int {
     std::cout << putTree.optionPrice() << ", " << putTree.calcDelta(0.0001)
               << '\n';
 
+    // without the full grid, a tree of 20000 steps needs one slice of
+    // 20000 values rather than 400 million nodes
+    EuroTree bigTree(100.0, 0.05, 0.2, 0.0, 100.0, 1.0, OptionType::Put,
+                     20000);
+    std::cout << bigTree.optionPrice() << '\n';
+
+    std::cout << '\n';
+  }
+
+  {
+    std::cout << '\n' << "*** American Exercise ***" << '\n';
+
+    const LatticeSettings american{.exercise = ExerciseStyle::American,
+                                   .exerciseBoundary = true};
+    EuroTree europeanPut(100.0, 0.05, 0.2, 0.0, 100.0, 1.0, OptionType::Put,
+                         2001);
+    EuroTree americanPut(100.0, 0.05, 0.2, 0.0, 100.0, 1.0, OptionType::Put,
+                         2001, american);
+    std::cout << "European put " << europeanPut.optionPrice()
+              << ", American put " << americanPut.optionPrice() << '\n';
+
+    // the spot below which the put is exercised, every quarter
+    auto boundary = americanPut.exerciseBoundary();
+    std::cout << "Exercise boundary:";
+    for (std::size_t j = 500; j < boundary.size(); j += 500) {
+      std::cout << ' ' << boundary[j];
+    }
+    std::cout << '\n';
+
+    // a call is only exercised early for a dividend, just before it is paid
+    LatticeSettings dividend = american;
+    dividend.dividends = {{0.5, 3.0}};
+    EuroTree americanCall(100.0, 0.05, 0.2, 0.0, 100.0, 1.0, OptionType::Call,
+                          2001, dividend);
+    dividend.exercise = ExerciseStyle::European;
+    EuroTree europeanCall(100.0, 0.05, 0.2, 0.0, 100.0, 1.0, OptionType::Call,
+                          2001, dividend);
+    std::cout << "With a dividend of 3 in six months, European call "
+              << europeanCall.optionPrice() << ", American call "
+              << americanCall.optionPrice() << ", exercised from "
+              << americanCall.exerciseBoundary()[999] << " the step before"
+              << '\n';
+
     std::cout << '\n';
   }
 
@@ -15,6 +15,9 @@ auto main() -> int {
     std::cout << x.optionPrice() << '\t' << x.calcDelta() << '\n';
     std::cout << y.optionPrice() << '\t' << y.calcDelta() << '\n';
 
+    // delta off the nodes of the pricing induction instead of two bumped trees
+    std::cout << x.calcGreeks().delta << '\t' << y.calcGreeks().delta << '\n';
+
     std::cout << '\n';
   }
 
@@ -29,6 +32,9 @@ auto main() -> int {
     std::cout << x.optionPrice() << '\t' << x.calcDelta() << '\n';
     std::cout << y.optionPrice() << '\t' << y.calcDelta() << '\n';
 
+    // pathwise delta from one simulation instead of two bumped ones
+    std::cout << x.calcGreeks().delta << '\t' << y.calcGreeks().delta << '\n';
+
     std::cout << '\n';
   }
 
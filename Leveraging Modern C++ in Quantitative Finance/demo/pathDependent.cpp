@@ -0,0 +1,36 @@
+#include "qf/MCPathOptPricer.hpp"
+#include "qf/OptionType.hpp"
+#include "qf/PathPayoffs.hpp"
+
+#include <cstddef>
+#include <iostream>
+
+auto main() -> int {
+  const Real S = 100.0;
+  const Real K = 100.0;
+  const Real r = 0.05;
+  const Real vol = 0.2;
+  const Real T = 1.0;
+  const std::size_t m = 252;
+  const std::size_t n = 10000;
+  const int seed = 0;
+  const Real q = 1.0;
+
+  MCPathOptPricer asian(S, r, vol, T, AsianPayoff<OptionType::Call>{K}, m, n,
+                        true, seed, q);
+  std::cout << "Asian call: " << asian() << " +/- " << asian.standardError()
+            << '\n';
+
+  MCPathOptPricer lookback(S, r, vol, T, LookbackPayoff<OptionType::Put>{K}, m,
+                           n, true, seed, q);
+  std::cout << "Lookback put: " << lookback() << " +/- "
+            << lookback.standardError() << '\n';
+
+  // knocked-out paths stop at the barrier; the vanilla call is the control
+  using DownAndOutCall =
+      BarrierPayoff<OptionType::Call, BarrierType::DownAndOut>;
+  MCPathOptPricer barrier(S, r, vol, T, DownAndOutCall{K, 90.0}, m, n, true,
+                          seed, q, {.controlVariate = true});
+  std::cout << "Down-and-out call: " << barrier() << " +/- "
+            << barrier.standardError() << '\n';
+}
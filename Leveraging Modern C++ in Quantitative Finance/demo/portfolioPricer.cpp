@@ -0,0 +1,48 @@
+#include "qf/BSMOptPricer.hpp"
+#include "qf/MCEuroOptPricer.hpp"
+#include "qf/MCPortfolioPricer.hpp"
+#include "qf/OptionType.hpp"
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+auto main() -> int {
+  const Real S = 100.0;
+  const Real r = 0.05;
+  const Real vol = 0.2;
+  const Real T = 1.0;
+  const std::size_t m = 252;
+  const std::size_t n = 10000;
+  const int seed = 0;
+
+  // calls and puts on nine strikes, expiring each quarter
+  std::vector<PortfolioOption> chain;
+  for (std::size_t quarter = 1; quarter <= 4; ++quarter) {
+    for (Real K = 80.0; K <= 120.0; K += 5.0) {
+      chain.push_back({K, OptionType::Call, 1.0, m * quarter / 4});
+      chain.push_back({K, OptionType::Put, 1.0, m * quarter / 4});
+    }
+  }
+
+  MCPortfolioPricer x(S, r, vol, T, m, n, true, seed, chain);
+  std::cout << chain.size() << " options on one simulation: " << x.time()
+            << "ms\n";
+
+  Real total = 0.0;
+  for (const auto &option : chain) {
+    Real t = T * static_cast<Real>(option.expiryStep) / static_cast<Real>(m);
+    MCEuroOptPricer y(S, option.strike, r, vol, t, option.porc,
+                      option.expiryStep, n, true, seed, option.quantity);
+    total += y.time();
+  }
+  std::cout << chain.size() << " options one at a time: " << total << "ms\n";
+
+  for (std::size_t k = 0; k < chain.size(); k += 17) {
+    const auto &option = chain[k];
+    Real t = T * static_cast<Real>(option.expiryStep) / static_cast<Real>(m);
+    BSMOptPricer z(S, option.strike, r, vol, t, option.porc, option.quantity);
+    std::cout << x.optionPrices()[k] << " +/- " << x.standardErrors()[k]
+              << '\t' << z() << '\n';
+  }
+}
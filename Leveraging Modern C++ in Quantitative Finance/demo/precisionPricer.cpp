@@ -0,0 +1,39 @@
+#include "qf/BSMOptPricer.hpp"
+#include "qf/EuroTree.hpp"
+#include "qf/MCEuroOptPricer.hpp"
+#include "qf/OptionType.hpp"
+
+#include <cstddef>
+#include <iostream>
+
+auto main() -> int {
+  const Real S = 100.0;
+  const Real K = 100.0;
+  const Real r = 0.05;
+  const Real vol = 0.25;
+  const Real T = 1.0;
+  const std::size_t m = 64;
+  const std::size_t n = 1000000;
+  const int seed = 0;
+
+  // the same option with double and float paths: the float run takes about
+  // half the time and its price stays within the standard error
+  BasicMCEuroOptPricer<double> x(S, K, r, vol, T, OptionType::Call, m, n,
+                                 true, seed, 1.0);
+  BasicMCEuroOptPricer<float> y(S, K, r, vol, T, OptionType::Call, m, n, true,
+                                seed, 1.0);
+  BSMOptPricer z(S, K, r, vol, T, OptionType::Call, 1.0);
+  std::cout << "double paths\t" << x() << " +/- " << x.standardError() << '\t'
+            << x.time() << "ms\n";
+  std::cout << "float paths\t" << y() << " +/- " << y.standardError() << '\t'
+            << y.time() << "ms\n";
+  std::cout << "Black-Scholes\t" << z() << '\n';
+
+  // a binomial tree of 1000 steps in float is within about 1e-4 of the
+  // double one
+  BasicEuroTree<double> u(S, r, vol, 0.0, K, T, OptionType::Call, 1000);
+  BasicEuroTree<float> v(100.0F, 0.05F, 0.25F, 0.0F, 100.0F, 1.0F,
+                         OptionType::Call, 1000);
+  std::cout << "tree, double\t" << u.optionPrice() << '\n';
+  std::cout << "tree, float\t" << v.optionPrice() << '\n';
+}
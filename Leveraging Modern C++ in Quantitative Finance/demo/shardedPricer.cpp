@@ -0,0 +1,56 @@
+#include "qf/MCEuroOptPricer.hpp"
+#include "qf/MCSettings.hpp"
+#include "qf/OptionType.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// One run shared among local processes, e.g. four:
+//   for k in 0 1 2 3; do shardedPricer $k 4 shard$k.bin & done; wait
+//   shardedPricer merge shard0.bin shard1.bin shard2.bin shard3.bin
+// The merge prints the result of the shards and that of a single process.
+
+const Real S = 100.0;
+const Real K = 100.0;
+const Real r = 0.05;
+const Real vol = 0.2;
+const Real T = 1.0;
+const std::size_t m = 252;
+const std::size_t n = 1000000;
+const int seed = 0;
+
+auto price(std::size_t shardIndex, std::size_t numShards) -> MCEuroOptPricer {
+  MCSettings settings{.controlVariate = true,
+                      .greeks = true,
+                      .numShards = numShards,
+                      .shardIndex = shardIndex};
+  return {S, K, r, vol, T, OptionType::Put, m, n, true, seed, 1.0, settings};
+}
+
+void print(const MCEuroOptPricer &x) {
+  std::cout << std::setprecision(17) << x() << " +/- " << x.standardError()
+            << ", delta " << x.calcGreeks().delta << " (" << x.time()
+            << "ms)\n";
+}
+
+auto main(int argc, char *argv[]) -> int {
+  const std::vector<std::string> args(argv + 1, argv + argc);
+  if (args.size() >= 2 && args[0] == "merge") {
+    std::vector<std::filesystem::path> files(args.begin() + 1, args.end());
+    print(MCEuroOptPricer::fromShards(files));
+    print(price(0, 1));
+  } else if (args.size() == 3) {
+    MCEuroOptPricer x = price(std::stoul(args[0]), std::stoul(args[1]));
+    x.writeShard(args[2]);
+    std::cout << x.numScenariosRun() << " scenarios: ";
+    print(x);
+  } else {
+    std::cerr << "usage: shardedPricer <shard> <shards> <file>\n"
+                 "       shardedPricer merge <file>...\n";
+    return 1;
+  }
+}
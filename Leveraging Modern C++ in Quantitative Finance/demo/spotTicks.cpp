@@ -0,0 +1,63 @@
+#include "qf/BSMOptPricer.hpp"
+#include "qf/OptionType.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <vector>
+
+auto main() -> int {
+  // a day of ticks on the spot, each repricing one option
+  const std::size_t numTicks = 1000000;
+  std::vector<Real> spots(numTicks);
+  std::mt19937_64 engine(0);
+  std::normal_distribution<Real> move(0.0, 0.01);
+  Real spot = 100.0;
+  for (Real &s : spots) {
+    spot += move(engine);
+    s = spot;
+  }
+  const Real K = 100.0;
+  const Real r = 0.05;
+  const Real q = 0.02;
+  const Real vol = 0.2;
+  const Real T = 0.5;
+
+  auto ms = [](auto b, auto e) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(e - b)
+        .count();
+  };
+
+  // a new pricer per tick recomputes everything
+  Real sum = 0.0;
+  auto b = std::chrono::steady_clock::now();
+  for (Real s : spots) {
+    sum += BSMOptPricer(s, K, r, q, vol, T, OptionType::Call, 1.0)();
+  }
+  auto e = std::chrono::steady_clock::now();
+  std::cout << "one BSMOptPricer per tick: " << ms(b, e) << "ms, average "
+            << sum / numTicks << '\n';
+
+  // resetSpot only takes the log of the spot and the two distribution values
+  BSMOptPricer pricer(100.0, K, r, q, vol, T, OptionType::Call, 1.0);
+  sum = 0.0;
+  b = std::chrono::steady_clock::now();
+  for (Real s : spots) {
+    sum += pricer.resetSpot(s);
+  }
+  e = std::chrono::steady_clock::now();
+  std::cout << "BSMOptPricer::resetSpot per tick: " << ms(b, e)
+            << "ms, average " << sum / numTicks << '\n';
+
+  // the same for a move of the volatility, which refreshes vol sqrt(T) and
+  // the drift term too
+  sum = 0.0;
+  b = std::chrono::steady_clock::now();
+  for (Real s : spots) {
+    sum += pricer.resetVolatility(vol * s / 100.0);
+  }
+  e = std::chrono::steady_clock::now();
+  std::cout << "BSMOptPricer::resetVolatility per tick: " << ms(b, e)
+            << "ms, average " << sum / numTicks << '\n';
+}
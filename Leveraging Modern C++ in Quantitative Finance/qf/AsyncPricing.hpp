@@ -0,0 +1,75 @@
+#ifndef QF_ASYNCPRICING_HPP
+#define QF_ASYNCPRICING_HPP
+
+#include <functional>
+#include <future>
+#include <limits>
+#include <stdexcept>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+
+using Real = double;
+
+// How far a pricing request has got: the fraction of the work done and, for
+// the Monte-Carlo pricers, the estimate so far and its standard error (NaN
+// where there is none)
+struct PricingProgress {
+  Real fraction = 0.0;
+  Real estimate = std::numeric_limits<Real>::quiet_NaN();
+  Real standardError = std::numeric_limits<Real>::quiet_NaN();
+};
+
+// thrown out of a pricer, and so out of its future, once its request has been
+// cancelled
+class PricingCancelled : public std::runtime_error {
+public:
+  PricingCancelled() : std::runtime_error("Pricing request cancelled!") {}
+};
+
+// Cooperative cancellation and progress reports for a pricer while it is
+// being constructed. The pricer looks at the stop token between units of
+// work, e.g. batches of scenarios or time steps of a tree, and reports its
+// progress as it goes; the default control never stops and reports nowhere.
+struct PricingControl {
+  std::stop_token stopToken;
+  std::function<void(const PricingProgress &)> onProgress;
+
+  // whether anyone can stop the pricer or is listening to it
+  [[nodiscard]] auto active() const -> bool {
+    return stopToken.stop_possible() || static_cast<bool>(onProgress);
+  }
+  [[nodiscard]] auto stopRequested() const -> bool {
+    return stopToken.stop_requested();
+  }
+  void throwIfStopped() const {
+    if (stopRequested()) {
+      throw PricingCancelled();
+    }
+  }
+  void report(const PricingProgress &progress) const {
+    if (onProgress) {
+      onProgress(progress);
+    }
+  }
+};
+
+// Constructs a pricer on a thread of its own and returns its future; make
+// receives the control of the request and passes it on to the constructor,
+// e.g. [=](const PricingControl &c) { return BSMOptPricer(..., c); }. Once a
+// stop is requested on stopToken, the future throws PricingCancelled. The
+// progress callback runs on the pricing thread.
+template <typename Make>
+[[nodiscard]] auto
+priceAsync(Make make, std::stop_token stopToken = {},
+           std::function<void(const PricingProgress &)> onProgress = {})
+    -> std::future<std::invoke_result_t<Make &, const PricingControl &>> {
+  auto run = [make = std::move(make),
+              control = PricingControl{std::move(stopToken),
+                                       std::move(onProgress)}]() mutable {
+    return make(control);
+  };
+  return std::async(std::launch::async, std::move(run));
+}
+
+#endif // QF_ASYNCPRICING_HPP
@@ -0,0 +1,374 @@
+#include "qf/BSMKernel.hpp"
+#include "qf/GBMKernel.hpp"
+#include "qf/LaneMath.hpp"
+#include "qf/ScenarioChunks.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <stdexcept>
+
+namespace {
+
+using qf::lanes::expLanes;
+using qf::lanes::logLanes;
+using qf::lanes::normalCdfLanes;
+
+// long enough for the lane loops to stay loops, which GCC vectorises, and short
+// enough for the block to stay in L1
+constexpr std::size_t W = 64;
+using Lanes = std::array<Real, W>;
+
+struct InputLanes {
+  Lanes spot;
+  Lanes strike;
+  Lanes rate;
+  Lanes dividend;
+  Lanes vol;
+  Lanes expiry;
+  Lanes sign; // 1 for a call, -1 for a put
+};
+
+// price, delta, gamma, vega, theta and rho of one unit
+using OutputLanes = std::array<Lanes, 6>;
+
+// the log-moneyness and the two discount factors, which do not depend on the
+// volatility
+struct CarryLanes {
+  Lanes logMoneyness;
+  Lanes discount;
+  Lanes divDiscount;
+};
+
+QF_KERNEL_INLINE void carryLanes(const InputLanes &in, CarryLanes &carry) {
+  for (std::size_t l = 0; l != W; ++l) {
+    carry.logMoneyness[l] = in.spot[l] / in.strike[l];
+    carry.discount[l] = -in.rate[l] * in.expiry[l];
+    carry.divDiscount[l] = -in.dividend[l] * in.expiry[l];
+  }
+  logLanes(carry.logMoneyness);
+  expLanes(carry.discount);
+  expLanes(carry.divDiscount);
+}
+
+// One option per lane: a call is S Q N(d1) - K D N(d2), with Q and D the
+// dividend and rate discount factors, and a put the same with d1, d2 and the
+// sign flipped, so both go through the same arithmetic. WithGreeks adds the
+// Greeks, which share d1, d2 and the two distribution values and only need
+// the normal density at d1 besides. With no volatility or no time left, d1 and
+// d2 are infinite, on the side of the strike the forward is, so that the
+// price is the discounted forward intrinsic value max(sign (S Q - K D), 0),
+// and the density, gamma and vega are 0.
+template <bool WithGreeks>
+QF_KERNEL_INLINE void evaluateLanes(const InputLanes &in,
+                                    const CarryLanes &carry,
+                                    OutputLanes &out) {
+  const Lanes &discount = carry.discount;
+  const Lanes &divDiscount = carry.divDiscount;
+  Lanes volSqrtT;
+  Lanes d1;
+  Lanes n1;
+  Lanes n2;
+  constexpr Real infinity = std::numeric_limits<Real>::infinity();
+  for (std::size_t l = 0; l != W; ++l) {
+    const Real vol = in.vol[l];
+    const Real forward =
+        in.spot[l] * divDiscount[l] - in.strike[l] * discount[l];
+    volSqrtT[l] = vol * std::sqrt(in.expiry[l]);
+    d1[l] = volSqrtT[l] == 0
+                ? (forward > 0 ? infinity : -infinity)
+                : (carry.logMoneyness[l] +
+                   (in.rate[l] - in.dividend[l] + vol * vol / 2) *
+                       in.expiry[l]) /
+                      volSqrtT[l];
+    n1[l] = in.sign[l] * d1[l];
+    n2[l] = in.sign[l] * (d1[l] - volSqrtT[l]);
+  }
+  normalCdfLanes(n1);
+  normalCdfLanes(n2);
+  // the polynomials of normalCdfLanes are not made for infinite arguments
+  for (std::size_t l = 0; l != W; ++l) {
+    const Real limit = in.sign[l] * d1[l] > 0 ? 1.0 : 0.0;
+    n1[l] = volSqrtT[l] == 0 ? limit : n1[l];
+    n2[l] = volSqrtT[l] == 0 ? limit : n2[l];
+  }
+  for (std::size_t l = 0; l != W; ++l) {
+    out[0][l] = in.sign[l] * (in.spot[l] * divDiscount[l] * n1[l] -
+                              in.strike[l] * discount[l] * n2[l]);
+  }
+  if constexpr (WithGreeks) {
+    Lanes density;
+    for (std::size_t l = 0; l != W; ++l) {
+      density[l] = -d1[l] * d1[l] / 2;
+    }
+    expLanes(density);
+    for (std::size_t l = 0; l != W; ++l) {
+      const Real sign = in.sign[l];
+      const Real spot = in.spot[l];
+      const Real expiry = in.expiry[l];
+      const bool flat = volSqrtT[l] == 0;
+      const Real pdf =
+          flat ? 0.0
+               : density[l] * std::numbers::inv_sqrtpi / std::sqrt(2.0);
+      const Real forwardPart = spot * divDiscount[l] * n1[l];
+      const Real strikePart = in.strike[l] * discount[l] * n2[l];
+      const Real vega = spot * divDiscount[l] * pdf * std::sqrt(expiry);
+      out[1][l] = sign * divDiscount[l] * n1[l];
+      out[2][l] = flat ? 0.0 : divDiscount[l] * pdf / (spot * volSqrtT[l]);
+      out[3][l] = vega;
+      out[4][l] = (flat ? 0.0 : -vega * in.vol[l] / (2 * expiry)) +
+                  sign * (in.dividend[l] * forwardPart -
+                          in.rate[l] * strikePart);
+      out[5][l] = sign * expiry * strikePart;
+    }
+  }
+}
+
+constexpr unsigned int maxVolIterations = 100;
+constexpr Real volTolerance = 1e-12;
+
+// Safeguarded Newton on the volatility of every lane at once. Each lane keeps
+// a bracket [lo, hi] that the price at every iterate narrows, as the price
+// rises with the volatility, and bisects it whenever its Newton step would
+// leave it; a converged lane, flagged in done, stops moving while the others
+// catch up. The last iterate is kept if maxVolIterations runs out, which only
+// happens once the price no longer resolves the volatility.
+QF_KERNEL_INLINE void impliedVolLanes(InputLanes &in, const CarryLanes &carry,
+                                      const Lanes &target, Lanes &done) {
+  Lanes lo;
+  Lanes hi;
+  lo.fill(minImpliedVol);
+  hi.fill(maxImpliedVol);
+  OutputLanes result;
+  for (unsigned int k = 0; k != maxVolIterations; ++k) {
+    evaluateLanes<true>(in, carry, result);
+    std::size_t numDone = 0;
+    for (std::size_t l = 0; l != W; ++l) {
+      const Real vol = in.vol[l];
+      const Real diff = result[0][l] - target[l];
+      lo[l] = diff < 0 ? vol : lo[l];
+      hi[l] = diff > 0 ? vol : hi[l];
+      const Real step = vol - diff / result[3][l];
+      const Real next =
+          step > lo[l] && step < hi[l] ? step : (lo[l] + hi[l]) / 2;
+      const bool stopped = done[l] != 0.0;
+      in.vol[l] = stopped ? vol : next;
+      done[l] = stopped || std::abs(next - vol) <= volTolerance ? 1.0 : 0.0;
+    }
+    for (std::size_t l = 0; l != W; ++l) {
+      numDone += done[l] != 0.0;
+    }
+    if (numDone == W) {
+      break;
+    }
+  }
+}
+
+// What one pass over a range of the batch computes: prices, prices and
+// Greeks, or, with vols set, the implied volatilities of targetPrices
+struct BSMJob {
+  const BSMBatch &batch;
+  BSMGreekSpans out{};
+  std::span<const Real> targetPrices{};
+  std::span<Real> vols{};
+};
+
+// the volatility is left alone when the batch has none
+QF_KERNEL_INLINE void loadLanes(const BSMBatch &batch, std::size_t i,
+                                std::size_t size, InputLanes &in) {
+  const bool dividends = !batch.dividendYields.empty();
+  const bool vols = !batch.volatilities.empty();
+  for (std::size_t l = 0; l != size; ++l) {
+    in.spot[l] = batch.spots[i + l];
+    in.strike[l] = batch.strikes[i + l];
+    in.rate[l] = batch.riskFreeRates[i + l];
+    in.dividend[l] = dividends ? batch.dividendYields[i + l] : 0.0;
+    in.vol[l] = vols ? batch.volatilities[i + l] : in.vol[l];
+    in.expiry[l] = batch.timesToExpiry[i + l];
+    in.sign[l] = batch.types[i + l] == OptionType::Call ? 1.0 : -1.0;
+  }
+}
+
+// the tail of a chunk is padded with an at-the-money option
+QF_KERNEL_INLINE void fillPadding(InputLanes &in) {
+  in.spot.fill(1.0);
+  in.strike.fill(1.0);
+  in.rate.fill(0.0);
+  in.dividend.fill(0.0);
+  in.vol.fill(1.0);
+  in.expiry.fill(1.0);
+  in.sign.fill(1.0);
+}
+
+template <bool WithGreeks>
+QF_KERNEL_INLINE void evaluateAny(const BSMJob &job, std::size_t first,
+                                  std::size_t last) {
+  InputLanes in;
+  fillPadding(in);
+  CarryLanes carry;
+  OutputLanes result;
+  const BSMGreekSpans &out = job.out;
+  const std::array<std::span<Real>, 6> dest{out.prices, out.deltas,
+                                            out.gammas, out.vegas,
+                                            out.thetas, out.rhos};
+  const std::size_t numOutputs = WithGreeks ? dest.size() : 1;
+  for (std::size_t i = first; i < last; i += W) {
+    const std::size_t size = std::min(W, last - i);
+    loadLanes(job.batch, i, size, in);
+    carryLanes(in, carry);
+    evaluateLanes<WithGreeks>(in, carry, result);
+    for (std::size_t k = 0; k != numOutputs; ++k) {
+      std::copy_n(result[k].begin(), size, dest[k].begin() + i);
+    }
+  }
+}
+
+// A lane whose price is not strictly between the no-arbitrage bounds, the
+// discounted intrinsic value and the prepaid forward for a call or the
+// discounted strike for a put, starts out done with a NaN volatility, and so
+// does padding; a lane that ends on the edge of the search interval has no
+// volatility within it.
+QF_KERNEL_INLINE void impliedVolAny(const BSMJob &job, std::size_t first,
+                                    std::size_t last) {
+  const bool warmStart = !job.batch.volatilities.empty();
+  InputLanes in;
+  fillPadding(in);
+  CarryLanes carry;
+  Lanes target;
+  Lanes done;
+  std::array<bool, W> valid{};
+  for (std::size_t i = first; i < last; i += W) {
+    const std::size_t size = std::min(W, last - i);
+    loadLanes(job.batch, i, size, in);
+    carryLanes(in, carry);
+    done.fill(1.0);
+    for (std::size_t l = 0; l != size; ++l) {
+      const Real price = job.targetPrices[i + l];
+      const Real forward = in.spot[l] * carry.divDiscount[l];
+      const Real strike = in.strike[l] * carry.discount[l];
+      const bool call = in.sign[l] > 0;
+      const Real lower = std::max(in.sign[l] * (forward - strike), 0.0);
+      const Real upper = call ? forward : strike;
+      valid[l] = in.expiry[l] > 0 && price > lower && price < upper;
+      const Real callPrice = call ? price : price + forward - strike;
+      const Real guess =
+          warmStart && in.vol[l] > minImpliedVol && in.vol[l] < maxImpliedVol
+              ? in.vol[l]
+              : bsmImpliedVolGuess(callPrice, forward, strike, in.expiry[l]);
+      target[l] = price;
+      in.vol[l] = valid[l] ? guess : 1.0;
+      done[l] = valid[l] ? 0.0 : 1.0;
+    }
+    impliedVolLanes(in, carry, target, done);
+    for (std::size_t l = 0; l != size; ++l) {
+      const Real vol = in.vol[l];
+      const bool inside = vol > minImpliedVol + volTolerance &&
+                          vol < maxImpliedVol - volTolerance;
+      job.vols[i + l] = valid[l] && inside
+                            ? vol
+                            : std::numeric_limits<Real>::quiet_NaN();
+    }
+  }
+}
+
+QF_KERNEL_INLINE void evaluateChunk(const BSMJob &job, std::size_t first,
+                                    std::size_t last) {
+  if (!job.vols.empty()) {
+    impliedVolAny(job, first, last);
+  } else if (job.out.deltas.empty()) {
+    evaluateAny<false>(job, first, last);
+  } else {
+    evaluateAny<true>(job, first, last);
+  }
+}
+
+void evaluateScalar(const BSMJob &job, std::size_t first, std::size_t last) {
+  evaluateChunk(job, first, last);
+}
+
+#ifdef QF_MULTIVERSION
+__attribute__((target("avx2,fma"))) void
+evaluateAVX2(const BSMJob &job, std::size_t first, std::size_t last) {
+  evaluateChunk(job, first, last);
+}
+
+__attribute__((target("avx512f,avx512dq"))) void
+evaluateAVX512(const BSMJob &job, std::size_t first, std::size_t last) {
+  evaluateChunk(job, first, last);
+}
+#endif
+
+void evaluate(const BSMJob &job, std::size_t first, std::size_t last) {
+  switch (gbmSimdLevel()) {
+#ifdef QF_MULTIVERSION
+  case SimdLevel::AVX512:
+    evaluateAVX512(job, first, last);
+    break;
+  case SimdLevel::AVX2:
+    evaluateAVX2(job, first, last);
+    break;
+#endif
+  default:
+    evaluateScalar(job, first, last);
+    break;
+  }
+}
+
+// the volatilities may be missing only when they are being solved for
+void evaluateBatch(const BSMJob &job, bool runParallel) {
+  const BSMBatch &batch = job.batch;
+  const std::size_t n = batch.spots.size();
+  const bool solving = !job.vols.empty();
+  if (batch.strikes.size() != n || batch.riskFreeRates.size() != n ||
+      (batch.volatilities.size() != n &&
+       !(solving && batch.volatilities.empty())) ||
+      batch.timesToExpiry.size() != n || batch.types.size() != n ||
+      (!batch.dividendYields.empty() && batch.dividendYields.size() != n)) {
+    throw std::invalid_argument("Batch inputs differ in size!");
+  }
+  const std::size_t numChunks =
+      runParallel ? std::min(numScenarioChunks(n),
+                             std::max(n / bsmChunkSize, std::size_t{1}))
+                  : 1;
+  runScenarioChunks(n, numChunks,
+                    [&](std::size_t, std::size_t first, std::size_t last) {
+                      evaluate(job, first, last);
+                    });
+}
+
+} // namespace
+
+void bsmPrices(const BSMBatch &batch, std::span<Real> prices,
+               bool runParallel) {
+  if (prices.size() != batch.spots.size()) {
+    throw std::invalid_argument("Batch inputs differ in size!");
+  }
+  evaluateBatch({.batch = batch, .out = {.prices = prices}}, runParallel);
+}
+
+void bsmGreeks(const BSMBatch &batch, const BSMGreekSpans &greeks,
+               bool runParallel) {
+  const std::size_t n = batch.spots.size();
+  for (std::span<Real> out : {greeks.prices, greeks.deltas, greeks.gammas,
+                              greeks.vegas, greeks.thetas, greeks.rhos}) {
+    if (out.size() != n) {
+      throw std::invalid_argument("Batch inputs differ in size!");
+    }
+  }
+  evaluateBatch({.batch = batch, .out = greeks}, runParallel);
+}
+
+void bsmImpliedVols(const BSMBatch &batch, std::span<const Real> prices,
+                    std::span<Real> vols, bool runParallel) {
+  const std::size_t n = batch.spots.size();
+  if (prices.size() != n || vols.size() != n) {
+    throw std::invalid_argument("Batch inputs differ in size!");
+  }
+  if (n == 0) {
+    return;
+  }
+  evaluateBatch({.batch = batch, .targetPrices = prices, .vols = vols},
+                runParallel);
+}
@@ -0,0 +1,92 @@
+#ifndef QF_BSMKERNEL_HPP
+#define QF_BSMKERNEL_HPP
+
+#include "qf/OptionType.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <span>
+
+using Real = double;
+
+// A batch of European options in structure-of-arrays layout: option i is
+// spots[i], strikes[i], ..., types[i], and every span has the same size;
+// dividendYields may be left empty for no dividends
+struct BSMBatch {
+  std::span<const Real> spots;
+  std::span<const Real> strikes;
+  std::span<const Real> riskFreeRates;
+  std::span<const Real> volatilities;
+  std::span<const Real> timesToExpiry;
+  std::span<const OptionType> types;
+  std::span<const Real> dividendYields{};
+};
+
+// Where bsmGreeks() writes the price and Greeks of one unit of each option,
+// with the conventions of Greeks.hpp; every span has the size of the batch
+struct BSMGreekSpans {
+  std::span<Real> prices;
+  std::span<Real> deltas{};
+  std::span<Real> gammas{};
+  std::span<Real> vegas{};
+  std::span<Real> thetas{};
+  std::span<Real> rhos{};
+};
+
+// Black-Scholes prices of one unit of each option of the batch, into prices
+// of the same size. The options go through the lanes of a SIMD kernel, with
+// polynomial log and exp and a single Chebyshev series for erfc in place of
+// the libm and Boost calls. Prices above a thousandth of the spot agree with
+// BSMOptPricer to 1e-12 relative; further out of the money both lose the
+// same digits to cancellation. A zero volatility or time to expiry gives the
+// discounted intrinsic value. With runParallel, batches of more than
+// bsmChunkSize options are split across the cores.
+void bsmPrices(const BSMBatch &batch, std::span<Real> prices,
+               bool runParallel = true);
+
+// Prices and all the Greeks of the batch in the same pass, from one
+// evaluation of d1, d2 and the normal distribution per option; it takes about
+// half as long again as the prices alone
+void bsmGreeks(const BSMBatch &batch, const BSMGreekSpans &greeks,
+               bool runParallel = true);
+
+// Implied volatilities of the batch from the prices of one unit of each
+// option, into vols of the same size. Every option starts from the volatility
+// in the batch, if it has any, and from bsmImpliedVolGuess() otherwise, then
+// takes safeguarded Newton steps on the vega of bsmGreeks(), bisecting
+// whenever a step would leave the bracket the earlier steps have narrowed.
+// The lanes of a block step in lockstep until all of them have converged,
+// usually within a few steps, and batches are split across the cores as in
+// bsmPrices(). A price outside the no-arbitrage bounds, or whose volatility
+// lies outside [minImpliedVol, maxImpliedVol], gives NaN.
+void bsmImpliedVols(const BSMBatch &batch, std::span<const Real> prices,
+                    std::span<Real> vols, bool runParallel = true);
+
+// the interval searched for an implied volatility
+inline constexpr Real minImpliedVol = 1e-4;
+inline constexpr Real maxImpliedVol = 10.0;
+
+// Corrado and Miller's closed-form approximation of the implied volatility of
+// a call, from its price, the prepaid forward S e^{-qT} and the discounted
+// strike K e^{-rT}: close at the money and a starting point elsewhere, so it
+// is kept within [0.01, 5]. A put goes through put-call parity first.
+[[nodiscard]] inline auto bsmImpliedVolGuess(Real callPrice,
+                                             Real prepaidForward,
+                                             Real discountedStrike,
+                                             Real timeToExpiry) -> Real {
+  const Real halfGap = (prepaidForward - discountedStrike) / 2;
+  const Real x = callPrice - halfGap;
+  const Real gap2 = 4 * halfGap * halfGap / std::numbers::pi;
+  const Real root = std::sqrt(std::max(x * x - gap2, 0.0));
+  const Real guess = std::sqrt(2 * std::numbers::pi / timeToExpiry) *
+                     (x + root) / (prepaidForward + discountedStrike);
+  // also maps a NaN to the floor
+  return guess > 0.01 ? std::min(guess, 5.0) : 0.01;
+}
+
+// fewest options a worker is given
+inline constexpr std::size_t bsmChunkSize = 16384;
+
+#endif // QF_BSMKERNEL_HPP
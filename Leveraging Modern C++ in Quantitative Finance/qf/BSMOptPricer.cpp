@@ -1,36 +1,173 @@
 #include "qf/BSMOptPricer.hpp"
+#include "qf/BSMKernel.hpp"
+#include "qf/Newton.hpp"
 #include "qf/OptionType.hpp"
 
+#include <algorithm>
 #include <boost/math/distributions.hpp>
 #include <chrono>
 #include <cmath>
 #include <limits>
+#include <stdexcept>
+#include <utility>
 
 BSMOptPricer::BSMOptPricer(Real spot, Real strike, Real riskFreeRate,
                            Real volatility, Real timeToExpiry,
-                           OptionType optionType, Real quantity)
+                           OptionType optionType, Real quantity,
+                           const PricingControl &control)
+    : BSMOptPricer(spot, strike, riskFreeRate, 0.0, volatility, timeToExpiry,
+                   optionType, quantity, control) {}
+
+BSMOptPricer::BSMOptPricer(Real spot, Real strike, Real riskFreeRate,
+                           Real dividendYield, Real volatility,
+                           Real timeToExpiry, OptionType optionType,
+                           Real quantity, const PricingControl &control)
     : spot_(spot), strike_(strike), riskFreeRate_(riskFreeRate),
-      volatility_(volatility), timeToExpiry_(timeToExpiry), porc_(optionType),
-      quantity_(quantity) {
+      dividendYield_(dividendYield), volatility_(volatility),
+      timeToExpiry_(timeToExpiry), porc_(optionType), quantity_(quantity) {
   price_ = 0.0;
   time_ = 0.0;
-  calculate_();
+  logStrike_ = std::log(strike_);
+  cacheTime_();
+  calculate_(control);
+}
+
+auto BSMOptPricer::resetSpot(Real newSpot) -> Real {
+  if (newSpot < 0) {
+    throw std::invalid_argument("Reset failed. Spot should be non-negative.");
+  }
+  if (newSpot != spot_) {
+    spot_ = newSpot;
+    computePrice_();
+  }
+  return price_;
+}
+
+auto BSMOptPricer::resetRiskFreeRate(Real newRiskFreeRate) -> Real {
+  if (newRiskFreeRate != riskFreeRate_) {
+    riskFreeRate_ = newRiskFreeRate;
+    cacheRate_();
+    cacheDrift_();
+    computePrice_();
+  }
+  return price_;
+}
+
+auto BSMOptPricer::resetDividendYield(Real newDividendYield) -> Real {
+  if (newDividendYield < 0) {
+    throw std::invalid_argument(
+        "Reset failed. Dividend yield should be non-negative.");
+  }
+  if (newDividendYield != dividendYield_) {
+    dividendYield_ = newDividendYield;
+    cacheDividend_();
+    cacheDrift_();
+    computePrice_();
+  }
+  return price_;
+}
+
+auto BSMOptPricer::resetVolatility(Real newVolatility) -> Real {
+  if (newVolatility < 0) {
+    throw std::invalid_argument(
+        "Reset failed. Volatility should be non-negative.");
+  }
+  if (newVolatility != volatility_) {
+    volatility_ = newVolatility;
+    volSqrtT_ = volatility_ * sqrtT_;
+    cacheDrift_();
+    computePrice_();
+  }
+  return price_;
+}
+
+auto BSMOptPricer::resetTimeToExpiry(Real newTimeToExpiry) -> Real {
+  if (newTimeToExpiry < 0) {
+    throw std::invalid_argument(
+        "Reset failed. Time to expiry should be non-negative.");
+  }
+  if (newTimeToExpiry != timeToExpiry_) {
+    timeToExpiry_ = newTimeToExpiry;
+    cacheTime_();
+    computePrice_();
+  }
+  return price_;
+}
+
+namespace {
+
+// 1 for a call and -1 for a put, which is a call with d1, d2 and the sign
+// flipped
+auto optionSign(OptionType porc) -> Real {
+  switch (porc) {
+  case OptionType::Call:
+    return 1.0;
+  case OptionType::Put:
+    return -1.0;
+  default: // This should never happen
+    return std::numeric_limits<Real>::quiet_NaN();
+  }
 }
 
+} // namespace
+
 auto BSMOptPricer::optionPrice() const -> Real { return price_; }
 
 auto BSMOptPricer::calcDelta() const -> Real {
+  return optionSign(porc_) * divDiscount_ * n1_;
+}
+
+// A put is a call with d1, d2 and the sign flipped, in every Greek but
+// gamma and vega, which are the same for both; all but the density at d1
+// comes from the cache
+auto BSMOptPricer::calcGreeks() const -> Greeks {
   boost::math::normal normDist;
-  Real d1 = (std::log(spot_ / strike_) +
-             (riskFreeRate_ + volatility_ * volatility_ / 2) * timeToExpiry_) /
-            (std::sqrt(timeToExpiry_) * volatility_);
-  if (porc_ == OptionType::Call) {
-    return boost::math::cdf(normDist, d1);
-  }
-  if (porc_ == OptionType::Put) {
-    return -boost::math::cdf(normDist, -d1);
+  const Real sign = optionSign(porc_);
+  const Real density = boost::math::pdf(normDist, d1_);
+  const Real forwardPart = spot_ * divDiscount_ * n1_;
+  const Real strikePart = discountedStrike_ * n2_;
+
+  Greeks g;
+  g.price = price_;
+  g.delta = quantity_ * sign * divDiscount_ * n1_;
+  g.gamma = quantity_ * divDiscount_ * density / (spot_ * volSqrtT_);
+  g.vega = quantity_ * spot_ * divDiscount_ * density * sqrtT_;
+  g.theta = -g.vega * volatility_ / (2 * timeToExpiry_) +
+            quantity_ * sign *
+                (dividendYield_ * forwardPart - riskFreeRate_ * strikePart);
+  g.rho = quantity_ * sign * timeToExpiry_ * strikePart;
+  return g;
+}
+
+auto BSMOptPricer::impliedVolatility(Real price, Real spot, Real strike,
+                                     Real riskFreeRate, Real dividendYield,
+                                     Real timeToExpiry, OptionType optionType)
+    -> Real {
+  const Real forward = spot * std::exp(-dividendYield * timeToExpiry);
+  const Real discountedStrike = strike * std::exp(-riskFreeRate * timeToExpiry);
+  const bool call = optionType == OptionType::Call;
+  const Real intrinsic = call ? forward - discountedStrike
+                              : discountedStrike - forward;
+  const Real upper = call ? forward : discountedStrike;
+  if (!(timeToExpiry > 0 && price > std::max(intrinsic, 0.0) &&
+        price < upper)) {
+    return std::numeric_limits<Real>::quiet_NaN();
   }
-  return std::numeric_limits<Real>::quiet_NaN();
+
+  const Real callPrice = call ? price : price + forward - discountedStrike;
+  const Real guess =
+      bsmImpliedVolGuess(callPrice, forward, discountedStrike, timeToExpiry);
+  // one pricer, whose volatility is reset at each step
+  BSMOptPricer pricer(spot, strike, riskFreeRate, dividendYield, guess,
+                      timeToExpiry, optionType, 1.0);
+  auto f = [&](Real vol) {
+    pricer.resetVolatility(vol);
+    const Greeks g = pricer.calcGreeks();
+    return std::pair{g.price - price, g.vega};
+  };
+  const Real vol = qf::root_finder::newton(f, minImpliedVol, maxImpliedVol,
+                                           guess, 1e-12);
+  return std::isfinite(vol) ? vol : std::numeric_limits<Real>::quiet_NaN();
 }
 
 auto BSMOptPricer::operator()() const -> Real { return this->optionPrice(); }
@@ -40,39 +177,54 @@ auto BSMOptPricer::time() const -> Real { return time_; }
 // Real normalCDF(Real x) { return std::erfc(-x / std::sqrt(2)) / 2; }
 // does not take infinity into account
 
+// Only log(S) and the two distribution values are computed here; the rest
+// comes from the cache
 void BSMOptPricer::computePrice_() {
-  Real d1 = (std::log(spot_ / strike_) +
-             (riskFreeRate_ + volatility_ * volatility_ / 2) * timeToExpiry_) /
-            (std::sqrt(timeToExpiry_) * volatility_);
-  Real d2 = d1 - std::sqrt(timeToExpiry_) * volatility_;
-
-  boost::math::normal stdNormDist;
-
-  switch (porc_) {
-  case OptionType::Call:
-    price_ = spot_ * boost::math::cdf(stdNormDist, d1) -
-             std::exp(-riskFreeRate_ * timeToExpiry_) * strike_ *
-                 boost::math::cdf(stdNormDist, d2);
-    price_ = price_ * quantity_;
-    break;
-  case OptionType::Put:
-    price_ = -spot_ * boost::math::cdf(stdNormDist, -d1) +
-             std::exp(-riskFreeRate_ * timeToExpiry_) * strike_ *
-                 boost::math::cdf(stdNormDist, -d2);
-    price_ = price_ * quantity_;
-    break;
-  default: // This should never happen
+  const Real sign = optionSign(porc_);
+  if (std::isnan(sign)) { // This should never happen
     price_ = std::numeric_limits<Real>::quiet_NaN();
-    break;
+    return;
   }
+  boost::math::normal stdNormDist;
+  d1_ = (std::log(spot_) - logStrikeLessDrift_) / volSqrtT_;
+  n1_ = boost::math::cdf(stdNormDist, sign * d1_);
+  n2_ = boost::math::cdf(stdNormDist, sign * (d1_ - volSqrtT_));
+  price_ = quantity_ * sign *
+           (spot_ * divDiscount_ * n1_ - discountedStrike_ * n2_);
+}
+
+void BSMOptPricer::cacheTime_() {
+  sqrtT_ = std::sqrt(timeToExpiry_);
+  volSqrtT_ = volatility_ * sqrtT_;
+  cacheRate_();
+  cacheDividend_();
+  cacheDrift_();
+}
+
+void BSMOptPricer::cacheRate_() {
+  discount_ = std::exp(-riskFreeRate_ * timeToExpiry_);
+  discountedStrike_ = strike_ * discount_;
+}
+
+void BSMOptPricer::cacheDividend_() {
+  divDiscount_ = std::exp(-dividendYield_ * timeToExpiry_);
+}
+
+void BSMOptPricer::cacheDrift_() {
+  logStrikeLessDrift_ =
+      logStrike_ -
+      (riskFreeRate_ - dividendYield_ + volatility_ * volatility_ / 2) *
+          timeToExpiry_;
 }
 
-void BSMOptPricer::calculate_() {
+void BSMOptPricer::calculate_(const PricingControl &control) {
   {
+    control.throwIfStopped();
     auto b = std::chrono::steady_clock::now();
     computePrice_();
     auto e = std::chrono::steady_clock::now();
     time_ = static_cast<Real>(
         std::chrono::duration_cast<std::chrono::milliseconds>(e - b).count());
+    control.report({1.0, price_, 0.0});
   }
 }
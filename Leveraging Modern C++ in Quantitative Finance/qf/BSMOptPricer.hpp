@@ -1,6 +1,8 @@
 #ifndef QF_BSMOPTPRICER_HPP
 #define QF_BSMOPTPRICER_HPP
 
+#include "qf/AsyncPricing.hpp"
+#include "qf/Greeks.hpp"
 #include "qf/OptionType.hpp"
 
 using Real = double;
@@ -8,22 +10,57 @@ using Real = double;
 class BSMOptPricer {
 public:
   BSMOptPricer(Real spot, Real strike, Real riskFreeRate, Real volatility,
-               Real timeToExpiry, OptionType optionType, Real quantity);
+               Real timeToExpiry, OptionType optionType, Real quantity,
+               const PricingControl &control = {});
+  // the same on a stock paying a continuous dividend yield
+  BSMOptPricer(Real spot, Real strike, Real riskFreeRate, Real dividendYield,
+               Real volatility, Real timeToExpiry, OptionType optionType,
+               Real quantity, const PricingControl &control = {});
+
+  // Setters for a market-data update, each returning the new price. The
+  // pricer caches what depends on each input apart, so a new spot costs one
+  // log and the two distribution values, and a new volatility, rate, dividend
+  // yield or time to expiry only refreshes the terms that involve it.
+  auto resetSpot(Real newSpot) -> Real;
+  auto resetRiskFreeRate(Real newRiskFreeRate) -> Real;
+  auto resetDividendYield(Real newDividendYield) -> Real;
+  auto resetVolatility(Real newVolatility) -> Real;
+  auto resetTimeToExpiry(Real newTimeToExpiry) -> Real;
 
   [[nodiscard]] auto optionPrice() const -> Real;
   [[nodiscard]] auto calcDelta() const -> Real;
 
+  // Closed-form Greeks of the position with its price, all from a single
+  // evaluation of d1, d2, the normal density at d1 and the two distribution
+  // values; bsmGreeks() in BSMKernel.hpp does the same for a whole batch
+  [[nodiscard]] auto calcGreeks() const -> Greeks;
+
+  // Volatility at which one unit is worth price, by qf::root_finder::newton
+  // on the vega of calcGreeks() from bsmImpliedVolGuess(), over the interval
+  // and with the NaN of bsmImpliedVols() in BSMKernel.hpp, which solves a
+  // whole chain at once
+  [[nodiscard]] static auto
+  impliedVolatility(Real price, Real spot, Real strike, Real riskFreeRate,
+                    Real dividendYield, Real timeToExpiry,
+                    OptionType optionType) -> Real;
+
   [[nodiscard]] auto operator()() const -> Real;
   [[nodiscard]] auto time() const -> Real;
 
 private:
-  void calculate_();
+  void calculate_(const PricingControl &control = {});
   void computePrice_();
+  // refresh the cached terms of the inputs they are named after
+  void cacheTime_();
+  void cacheRate_();
+  void cacheDividend_();
+  void cacheDrift_();
 
   // model inputs
   Real spot_;
   Real strike_;
   Real riskFreeRate_;
+  Real dividendYield_;
   Real volatility_;
   Real timeToExpiry_;
   OptionType porc_;
@@ -33,6 +70,20 @@ private:
   // computed values
   Real price_;
 
+  // cached terms: sqrt(T) and vol sqrt(T), the discount factors e^{-rT} and
+  // e^{-qT}, the discounted strike, log(K) less the drift of log(S) to expiry,
+  // (r - q + vol^2 / 2) T, and d1 with N(d1) and N(d2), signed for a put
+  Real sqrtT_;
+  Real volSqrtT_;
+  Real discount_;
+  Real divDiscount_;
+  Real discountedStrike_;
+  Real logStrike_;
+  Real logStrikeLessDrift_;
+  Real d1_;
+  Real n1_;
+  Real n2_;
+
   // runtime comparison using concurrency
   Real time_;
 };
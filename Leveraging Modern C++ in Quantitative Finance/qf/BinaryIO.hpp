@@ -0,0 +1,23 @@
+#ifndef QF_BINARYIO_HPP
+#define QF_BINARYIO_HPP
+
+#include <istream>
+#include <ostream>
+#include <type_traits>
+
+// Raw native-endian values, for partial results exchanged between processes
+// of the same build on one kind of machine; stream errors are left for the
+// caller to check.
+template <typename T>
+  requires std::is_trivially_copyable_v<T>
+void writeBinary(std::ostream &out, const T &value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+  requires std::is_trivially_copyable_v<T>
+void readBinary(std::istream &in, T &value) {
+  in.read(reinterpret_cast<char *>(&value), sizeof(T));
+}
+
+#endif // QF_BINARYIO_HPP
@@ -0,0 +1,164 @@
+#ifndef QF_BLOCKREDUCTION_HPP
+#define QF_BLOCKREDUCTION_HPP
+
+#include "qf/ScenarioChunks.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// scenarios per block, the unit of work of the reductions below
+inline constexpr std::size_t scenarioBlockSize = 1024;
+
+// blocks of numScenarios scenarios, the last of which may be short; there is
+// always at least one, so that even an empty run yields a partial result
+[[nodiscard]] inline auto numScenarioBlocks(std::size_t numScenarios)
+    -> std::size_t {
+  return std::max((numScenarios + scenarioBlockSize - 1) / scenarioBlockSize,
+                  std::size_t{1});
+}
+
+// Merges the partial results of consecutive scenario blocks in a fixed binary
+// tree over the block index, so the floating-point result depends on the
+// number of blocks only, never on how they were shared among workers, batches
+// or processes. Blocks are pushed in order, singly or as a node of 2^level
+// blocks aligned to its size; two neighbouring nodes are merged as soon as
+// they are the halves of an aligned node, as a binary counter carries, so
+// only a logarithmic number of nodes is pending. A reduction may start at any
+// block, e.g. that of a shard, and its pending nodes may be pushed into
+// another that has reached them. Partial needs a merge(const Partial &) that
+// adds the right operand.
+template <typename Partial> class BlockReduction {
+public:
+  struct Node {
+    std::size_t firstBlock;
+    std::size_t level; // the node spans 2^level blocks
+    Partial partial;
+  };
+
+  explicit BlockReduction(std::size_t firstBlock = 0)
+      : nextBlock_(firstBlock) {}
+
+  // the first block not yet pushed
+  [[nodiscard]] auto nextBlock() const -> std::size_t { return nextBlock_; }
+
+  void push(std::size_t level, Partial partial) {
+    const std::size_t size = std::size_t{1} << level;
+    if (nextBlock_ % size != 0) {
+      throw std::invalid_argument("Block partial is not aligned to its size!");
+    }
+    nodes_.push_back({nextBlock_, level, std::move(partial)});
+    nextBlock_ += size;
+    while (nodes_.size() > 1 &&
+           nodes_[nodes_.size() - 2].level == nodes_.back().level &&
+           nodes_[nodes_.size() - 2].firstBlock %
+                   (std::size_t{2} << nodes_.back().level) ==
+               0) {
+      Node right = std::move(nodes_.back());
+      nodes_.pop_back();
+      nodes_.back().partial.merge(right.partial);
+      ++nodes_.back().level;
+    }
+  }
+
+  // nodes not merged yet, in block order
+  [[nodiscard]] auto nodes() const -> const std::vector<Node> & {
+    return nodes_;
+  }
+
+  // merge of all the blocks pushed so far, the pending nodes folded from the
+  // right
+  [[nodiscard]] auto result() const -> Partial {
+    if (nodes_.empty()) {
+      return Partial{};
+    }
+    Partial acc = nodes_.back().partial;
+    for (auto it = std::next(nodes_.rbegin()); it != nodes_.rend(); ++it) {
+      Partial left = it->partial;
+      left.merge(acc);
+      acc = std::move(left);
+    }
+    return acc;
+  }
+
+private:
+  std::vector<Node> nodes_;
+  std::size_t nextBlock_ = 0;
+};
+
+// Partials of blocks [firstBlock, lastBlock) as the largest aligned nodes that
+// tile the range, each reduced block by block as BlockReduction would;
+// accumulate(first, last) gives the partial of scenarios [first, last).
+template <typename Accumulate>
+[[nodiscard]] auto blockNodes(std::size_t firstBlock, std::size_t lastBlock,
+                              std::size_t numScenarios, Accumulate &accumulate)
+    -> std::vector<typename BlockReduction<
+        std::invoke_result_t<Accumulate &, std::size_t, std::size_t>>::Node> {
+  using Partial = std::invoke_result_t<Accumulate &, std::size_t, std::size_t>;
+  std::vector<typename BlockReduction<Partial>::Node> nodes;
+  for (std::size_t block = firstBlock; block < lastBlock;) {
+    std::size_t level = 0;
+    while (block % (std::size_t{2} << level) == 0 &&
+           block + (std::size_t{2} << level) <= lastBlock) {
+      ++level;
+    }
+    const std::size_t first = block;
+    BlockReduction<Partial> node(first);
+    for (; block != first + (std::size_t{1} << level); ++block) {
+      node.push(0, accumulate(block * scenarioBlockSize,
+                              std::min((block + 1) * scenarioBlockSize,
+                                       numScenarios)));
+    }
+    nodes.push_back({first, level, node.result()});
+  }
+  return nodes;
+}
+
+// Pushes blocks [reduction.nextBlock(), lastBlock) of numScenarios scenarios
+// into reduction, with one contiguous run of blocks per worker when running
+// in parallel. The result is the same for any number of workers. Each worker
+// calls its own copy of accumulate, so that what it captures by value, such
+// as a ScenarioNormals, carries over from block to block without a lock.
+template <typename Partial, typename Accumulate>
+void reduceScenarioBlocks(BlockReduction<Partial> &reduction,
+                          std::size_t lastBlock, std::size_t numScenarios,
+                          bool runParallel, Accumulate &&accumulate) {
+  const std::size_t firstBlock = reduction.nextBlock();
+  const std::size_t numBlocks = lastBlock - firstBlock;
+  const std::size_t numChunks =
+      runParallel ? numScenarioChunks(numBlocks) : 1;
+
+  std::vector<std::vector<typename BlockReduction<Partial>::Node>> nodes(
+      numChunks);
+  runScenarioChunks(numBlocks, numChunks,
+                    [&](std::size_t k, std::size_t first, std::size_t last) {
+                      auto chunkAccumulate = accumulate;
+                      nodes[k] = blockNodes(firstBlock + first,
+                                            firstBlock + last, numScenarios,
+                                            chunkAccumulate);
+                    });
+
+  for (auto &chunk : nodes) {
+    for (auto &node : chunk) {
+      reduction.push(node.level, std::move(node.partial));
+    }
+  }
+}
+
+// partial result of all numScenarios scenarios, reduced as above
+template <typename Accumulate>
+[[nodiscard]] auto reduceScenarios(std::size_t numScenarios, bool runParallel,
+                                   Accumulate &&accumulate)
+    -> std::invoke_result_t<Accumulate &, std::size_t, std::size_t> {
+  BlockReduction<std::invoke_result_t<Accumulate &, std::size_t, std::size_t>>
+      reduction;
+  reduceScenarioBlocks(reduction, numScenarioBlocks(numScenarios),
+                       numScenarios, runParallel, accumulate);
+  return reduction.result();
+}
+
+#endif // QF_BLOCKREDUCTION_HPP
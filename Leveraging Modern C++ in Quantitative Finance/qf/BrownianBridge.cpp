@@ -0,0 +1,66 @@
+#include "qf/BrownianBridge.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+// Point i of the path is the Brownian motion at time i + 1 in units of one
+// step. Each new point l is placed halfway between the nearest points already
+// built, j - 1 on the left (or the origin when j is 0) and k on the right.
+BrownianBridge::BrownianBridge(std::size_t numSteps)
+    : numSteps_(numSteps), leftIndex_(numSteps), rightIndex_(numSteps),
+      bridgeIndex_(numSteps), leftWeight_(numSteps), rightWeight_(numSteps),
+      stdDev_(numSteps) {
+  if (numSteps_ == 0) {
+    throw std::invalid_argument("A Brownian bridge needs a time step!");
+  }
+
+  std::vector<bool> built(numSteps_, false);
+  built[numSteps_ - 1] = true;
+  bridgeIndex_[0] = numSteps_ - 1;
+  stdDev_[0] = std::sqrt(static_cast<Real>(numSteps_));
+
+  std::size_t j = 0;
+  for (std::size_t i = 1; i != numSteps_; ++i) {
+    while (built[j]) {
+      ++j;
+    }
+    std::size_t k = j;
+    while (!built[k]) {
+      ++k;
+    }
+    std::size_t l = j + (k - 1 - j) / 2;
+    built[l] = true;
+
+    Real span = static_cast<Real>(k + 1 - j);
+    bridgeIndex_[i] = l;
+    leftIndex_[i] = j;
+    rightIndex_[i] = k;
+    leftWeight_[i] = static_cast<Real>(k - l) / span;
+    rightWeight_[i] = static_cast<Real>(l + 1 - j) / span;
+    stdDev_[i] = std::sqrt(static_cast<Real>(l + 1 - j) *
+                           static_cast<Real>(k - l) / span);
+
+    j = k + 1;
+    if (j >= numSteps_) {
+      j = 0;
+    }
+  }
+}
+
+auto BrownianBridge::numSteps() const -> std::size_t { return numSteps_; }
+
+void BrownianBridge::transform(std::span<const Real> z,
+                               std::span<Real> increments) const {
+  std::span<Real> path = increments;
+  path[numSteps_ - 1] = stdDev_[0] * z[0];
+  for (std::size_t i = 1; i != numSteps_; ++i) {
+    std::size_t j = leftIndex_[i];
+    std::size_t k = rightIndex_[i];
+    std::size_t l = bridgeIndex_[i];
+    Real left = j != 0 ? leftWeight_[i] * path[j - 1] : 0.0;
+    path[l] = left + rightWeight_[i] * path[k] + stdDev_[i] * z[i];
+  }
+  for (std::size_t i = numSteps_ - 1; i != 0; --i) {
+    increments[i] = path[i] - path[i - 1];
+  }
+}
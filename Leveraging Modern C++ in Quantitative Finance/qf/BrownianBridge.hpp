@@ -0,0 +1,36 @@
+#ifndef QF_BROWNIANBRIDGE_HPP
+#define QF_BROWNIANBRIDGE_HPP
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+using Real = double;
+
+// Brownian-bridge construction of a path of numSteps equal time steps
+// (Jaeckel, "Monte Carlo Methods in Finance", 2002, ch. 10). The first normal
+// fixes the end point, the second the midpoint, and so on by bisection, so
+// the leading dimensions of a low-discrepancy point decide the coarse shape
+// of the path and carry most of its variance.
+class BrownianBridge {
+public:
+  explicit BrownianBridge(std::size_t numSteps);
+
+  [[nodiscard]] auto numSteps() const -> std::size_t;
+
+  // increments of the path built from the standard normals z, scaled to unit
+  // variance, so they are again independent standard normals; z and
+  // increments must not overlap
+  void transform(std::span<const Real> z, std::span<Real> increments) const;
+
+private:
+  std::size_t numSteps_;
+  std::vector<std::size_t> leftIndex_;
+  std::vector<std::size_t> rightIndex_;
+  std::vector<std::size_t> bridgeIndex_;
+  std::vector<Real> leftWeight_;
+  std::vector<Real> rightWeight_;
+  std::vector<Real> stdDev_;
+};
+
+#endif // QF_BROWNIANBRIDGE_HPP
@@ -1,40 +1,66 @@
 #include "qf/EquityPriceGenerator.hpp"
+#include "qf/GBMKernel.hpp"
 
+#include <cmath>
 #include <limits>
 #include <random>
 #include <stdexcept>
 
-EquityPriceGenerator::EquityPriceGenerator(Real initEquityPrice,
-                                           std::size_t numTimeSteps,
-                                           Real timeToExpiry, Real drift,
-                                           Real volatility)
-    : dt_(timeToExpiry / static_cast<double>(numTimeSteps)),
+template <typename T>
+BasicEquityPriceGenerator<T>::BasicEquityPriceGenerator(
+    T initEquityPrice, std::size_t numTimeSteps, T timeToExpiry, T drift,
+    T volatility)
+    : dt_(timeToExpiry / static_cast<T>(numTimeSteps)),
       initEquityPrice_(initEquityPrice), numTimeSteps_(numTimeSteps),
-      drift_(drift), volatility_(volatility) {
+      timeToExpiry_(timeToExpiry), drift_(drift), volatility_(volatility),
+      driftTerm_((drift_ - (volatility_ * volatility_) / 2) * dt_),
+      diffusionTerm_(volatility_ * std::sqrt(dt_)) {
   if (numTimeSteps_ == std::numeric_limits<std::size_t>::max()) {
     throw std::invalid_argument("Too many steps in one simulation!");
   }
 }
 
-auto EquityPriceGenerator::operator()(int seed) const -> std::vector<Real> {
-  std::vector<Real> v;
-  v.reserve(numTimeSteps_ + 1);
-  v.push_back(initEquityPrice_);
+template <typename T>
+auto BasicEquityPriceGenerator<T>::operator()(int seed) const
+    -> std::vector<T> {
+  std::mt19937_64 mtEngine(seed);
+  std::normal_distribution<T> nd;
+  return (*this)([&]() { return nd(mtEngine); });
+}
 
-  Real equityPrice = initEquityPrice_;
+template <typename T>
+auto BasicEquityPriceGenerator<T>::terminalPrice(int seed) const -> T {
   std::mt19937_64 mtEngine(seed);
-  std::normal_distribution nd;
+  std::normal_distribution<T> nd;
+  return terminalPrice([&]() { return nd(mtEngine); });
+}
 
-  auto getNextPrice = [this](Real currentPrice, Real normDist) {
-    Real expArg1 = (drift_ - (volatility_ * volatility_) / 2) * dt_;
-    Real expArg2 = volatility_ * sqrt(dt_) * normDist;
-    return currentPrice * exp(expArg1 + expArg2);
-  };
+template <typename T>
+auto BasicEquityPriceGenerator<T>::exactTerminalPrice(int seed) const -> T {
+  std::mt19937_64 mtEngine(seed);
+  std::normal_distribution<T> nd;
+  return exactTerminalPrice([&]() { return nd(mtEngine); });
+}
 
-  for (std::size_t i = 0; i != numTimeSteps_; ++i) {
-    equityPrice = getNextPrice(equityPrice, nd(mtEngine));
-    v.push_back(equityPrice);
-  }
+template <typename T>
+void BasicEquityPriceGenerator<T>::terminalPrices(
+    std::uint64_t seed, std::uint64_t firstStream, std::span<T> out,
+    std::span<T> mirroredOut) const {
+  BasicGBMStepParams<T> params{initEquityPrice_, driftTerm_, diffusionTerm_,
+                               numTimeSteps_};
+  gbmTerminalPrices(params, seed, firstStream, out, mirroredOut);
+}
 
-  return v; // RVO
+template <typename T>
+void BasicEquityPriceGenerator<T>::exactTerminalPrices(
+    std::uint64_t seed, std::uint64_t firstStream, std::span<T> out,
+    std::span<T> mirroredOut) const {
+  BasicGBMStepParams<T> params{
+      initEquityPrice_,
+      (drift_ - (volatility_ * volatility_) / 2) * timeToExpiry_,
+      volatility_ * std::sqrt(timeToExpiry_), 1};
+  gbmTerminalPrices(params, seed, firstStream, out, mirroredOut);
 }
+
+template class BasicEquityPriceGenerator<float>;
+template class BasicEquityPriceGenerator<double>;
@@ -1,23 +1,119 @@
 #ifndef QF_EQUITYPRICEGENERATOR_HPP
 #define QF_EQUITYPRICEGENERATOR_HPP
 
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <span>
 #include <vector>
 
 using Real = double;
 
-class EquityPriceGenerator {
+// Source of standard normal draws, e.g. a PhiloxNormalGenerator or a lambda
+// wrapping std::normal_distribution and an engine
+template <typename Gen>
+concept NormalGenerator = std::invocable<Gen &> &&
+    std::convertible_to<std::invoke_result_t<Gen &>, Real>;
+
+// T is the precision of the paths; the float paths of terminalPrices() run
+// about twice as fast as the double ones (see GBMKernel.hpp)
+template <typename T> class BasicEquityPriceGenerator {
 public:
-  EquityPriceGenerator(Real initEquityPrice, std::size_t numTimeSteps,
-                       Real timeToExpiry, Real drift, Real volatility);
+  BasicEquityPriceGenerator(T initEquityPrice, std::size_t numTimeSteps,
+                            T timeToExpiry, T drift, T volatility);
+
+  // full path of numTimeSteps + 1 prices, starting with initEquityPrice;
+  // the seed initialises a std::mt19937_64 engine
+  [[nodiscard]] auto operator()(int seed) const -> std::vector<T>;
+
+  // last price of the path operator()(seed) would return, without storing it
+  [[nodiscard]] auto terminalPrice(int seed) const -> T;
+
+  // price at timeToExpiry drawn from its log-normal law in a single step;
+  // same distribution as terminalPrice(), but one normal draw per scenario
+  [[nodiscard]] auto exactTerminalPrice(int seed) const -> T;
+
+  // the same three, drawing from any source of standard normals
+  template <NormalGenerator Gen>
+  [[nodiscard]] auto operator()(Gen &&normals) const -> std::vector<T> {
+    std::vector<T> v;
+    v.reserve(numTimeSteps_ + 1);
+    v.push_back(initEquityPrice_);
+
+    T equityPrice = initEquityPrice_;
+    for (std::size_t i = 0; i != numTimeSteps_; ++i) {
+      T z = static_cast<T>(normals());
+      equityPrice *= std::exp(driftTerm_ + diffusionTerm_ * z);
+      v.push_back(equityPrice);
+    }
+
+    return v; // RVO
+  }
 
-  [[nodiscard]] auto operator()(int seed) const -> std::vector<Real>;
+  template <NormalGenerator Gen>
+  [[nodiscard]] auto terminalPrice(Gen &&normals) const -> T {
+    T equityPrice = initEquityPrice_;
+    for (std::size_t i = 0; i != numTimeSteps_; ++i) {
+      T z = static_cast<T>(normals());
+      equityPrice *= std::exp(driftTerm_ + diffusionTerm_ * z);
+    }
+    return equityPrice;
+  }
+
+  template <NormalGenerator Gen>
+  [[nodiscard]] auto exactTerminalPrice(Gen &&normals) const -> T {
+    T expArg1 = (drift_ - (volatility_ * volatility_) / 2) * timeToExpiry_;
+    T expArg2 = volatility_ * std::sqrt(timeToExpiry_) *
+                static_cast<T>(normals());
+    return initEquityPrice_ * std::exp(expArg1 + expArg2);
+  }
+
+  // walks the path operator()(normals) would return without storing it:
+  // visit(i, price) sees the price after each step i = 1, ..., numTimeSteps
+  // and ends the walk early by returning false
+  template <NormalGenerator Gen, typename Visitor>
+    requires std::predicate<Visitor &, std::size_t, T>
+  void walk(Gen &&normals, Visitor &&visit) const {
+    T equityPrice = initEquityPrice_;
+    for (std::size_t i = 1; i <= numTimeSteps_; ++i) {
+      T z = static_cast<T>(normals());
+      equityPrice *= std::exp(driftTerm_ + diffusionTerm_ * z);
+      if (!visit(i, equityPrice)) {
+        return;
+      }
+    }
+  }
+
+  // terminal prices of the Philox streams firstStream, firstStream + 1, ...
+  // under key seed, one per element of out. Same draws as terminalPrice() and
+  // exactTerminalPrice() with a PhiloxNormalGenerator, but many paths at once
+  // through the SIMD kernel of GBMKernel.hpp, so results agree to rounding.
+  // The float kernel draws its own normals, four per Philox block, so its
+  // paths only agree in law. A non-empty mirroredOut receives the antithetic
+  // path of each stream.
+  void terminalPrices(std::uint64_t seed, std::uint64_t firstStream,
+                      std::span<T> out,
+                      std::span<T> mirroredOut = {}) const;
+  void exactTerminalPrices(std::uint64_t seed, std::uint64_t firstStream,
+                           std::span<T> out,
+                           std::span<T> mirroredOut = {}) const;
 
 private:
-  const Real dt_;
-  const Real initEquityPrice_;
+  const T dt_;
+  const T initEquityPrice_;
   const std::size_t numTimeSteps_;
-  const Real drift_;
-  const Real volatility_;
+  const T timeToExpiry_;
+  const T drift_;
+  const T volatility_;
+
+  // exponent of one step is driftTerm_ + diffusionTerm_ * z
+  const T driftTerm_;
+  const T diffusionTerm_;
 };
 
+extern template class BasicEquityPriceGenerator<float>;
+extern template class BasicEquityPriceGenerator<double>;
+
+using EquityPriceGenerator = BasicEquityPriceGenerator<Real>;
+
 #endif // QF_EQUITYPRICEGENERATOR_HPP
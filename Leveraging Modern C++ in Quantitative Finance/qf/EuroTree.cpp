@@ -1,162 +1,793 @@
-#include "qf/EuroTree.hpp"
-#include "qf/OptionType.hpp"
-
-#include <algorithm>
-#include <cmath>
-#include <limits>
-#include <stdexcept>
-
-using std::exp;
-using std::make_tuple;
-using std::max;
-using std::min;
-using std::sqrt;
-using std::tuple;
-
-EuroTree::EuroTree(Real mktPrice, Real mktRate, Real mktVol, Real divRate,
-                   Real strike, Real expiry, OptionType porc, int numTimePoints)
-    : mktPrice_(mktPrice), mktRate_(mktRate), mktVol_(mktVol),
-      divRate_(divRate), strike_(strike), expiry_(expiry), porc_(porc),
-      numTimePoints_(numTimePoints) {
-  dt_ = u_ = d_ = p_ = discFctr_ = optionPrice_ = 0.0;
-  calcPrice_();
-}
-
-auto EuroTree::optionPrice() const -> Real { return optionPrice_; }
-
-auto EuroTree::calcDelta(Real pctShift) const -> Real {
-  if (pctShift == 0) {
-    throw std::invalid_argument(
-        "Non-zero price change required to compute delta");
-  }
-  EuroTree uTree(*this); // tree if mktPrice does up
-  EuroTree dTree(*this); // tree if mkrPrice does downn
-  Real delta = (uTree.resetMktPrice(mktPrice_ * (1 + pctShift)) -
-                dTree.resetMktPrice(mktPrice_ * (1 - pctShift))) /
-               (2 * pctShift * mktPrice_);
-  return delta;
-}
-
-auto EuroTree::operator()(std::size_t i, std::size_t j) const -> EuroNode {
-  return grid_[i][j];
-}
-
-auto EuroTree::grid() const -> boost::multi_array<EuroNode, 2> { return grid_; }
-
-auto EuroTree::resetMktPrice(Real newMktPrice) -> Real {
-  if (newMktPrice < 0) {
-    throw std::invalid_argument(
-        "Reset failed. Market price should be non-negative.");
-  }
-  if (newMktPrice != mktPrice_) {
-    mktPrice_ = newMktPrice;
-    calcPrice_();
-  }
-  return optionPrice_;
-}
-
-auto EuroTree::resetMktRate(Real newMktRate) -> Real {
-  if (newMktRate != mktRate_) {
-    mktRate_ = newMktRate;
-    calcPrice_();
-  }
-  return optionPrice_;
-}
-
-auto EuroTree::resetDivRate(Real newDivRate) -> Real {
-  if (newDivRate < 0) {
-    throw std::invalid_argument(
-        "Reset failed. Stock dividend should be non-negative.");
-  }
-  if (newDivRate != divRate_) {
-    divRate_ = newDivRate;
-    calcPrice_();
-  }
-  return optionPrice_;
-}
-
-auto EuroTree::resetMktVol(Real newMktVol) -> Real {
-  if (newMktVol < 0) {
-    throw std::invalid_argument(
-        "Reset failed. Market volatility should be non-negative.");
-  }
-  if (newMktVol != mktVol_) {
-    mktVol_ = newMktVol;
-    calcPrice_();
-  }
-  return optionPrice_;
-}
-
-void EuroTree::calcPrice_() {
-  paramInit_();
-  gridSetup_();
-  projectPrices_();
-  calcPayoffs_();
-  optionPrice_ = this->operator()(0, 0).payoff;
-}
-
-void EuroTree::paramInit_() {
-  // Real yfToExpiry = dayCount_(valueDate_, expireDate_);
-  dt_ = expiry_ / (static_cast<Real>(numTimePoints_) - 1.0);
-  u_ = exp(mktVol_ * sqrt(dt_));
-  d_ = 1.0 / u_;
-  p_ = (exp((mktRate_ - divRate_) * dt_) - d_) / (u_ - d_);
-  discFctr_ = exp(-mktRate_ * dt_);
-}
-
-void EuroTree::gridSetup_() {
-  grid_.resize(boost::extents[numTimePoints_][numTimePoints_]);
-}
-
-void EuroTree::projectPrices_() {
-  grid_[0][0].underlying = mktPrice_;
-
-  for (std::size_t j = 1; j < numTimePoints_; ++j) {
-    for (std::size_t i = 0; i <= j; ++i) {
-      if (i < j) {
-        grid_[i][j].underlying = d_ * grid_[i][j - 1].underlying;
-      } else {
-        grid_[i][j].underlying = u_ * grid_[i - 1][j - 1].underlying;
-      }
-    }
-  }
-}
-
-void EuroTree::calcPayoffs_() {
-  auto payoff = [this](Real underlying) {
-    if (porc_ == OptionType::Call) {
-      return max(underlying - strike_, 0.0);
-    }
-    return max(strike_ - underlying, 0.0);
-  };
-
-  for (std::size_t j = numTimePoints_ - 1;; --j) {
-    for (std::size_t i = 0; i <= j; ++i) {
-      if (j == numTimePoints_ - 1) {
-        grid_[i][j].payoff = payoff(grid_[i][j].underlying);
-      } else {
-        grid_[i][j].payoff = discFctr_ * (p_ * grid_[i + 1][j + 1].payoff +
-                                          (1.0 - p_) * grid_[i][j + 1].payoff);
-      }
-    }
-    if (j == 0) {
-      break;
-    }
-  }
-}
-
-/*
-        Copyright 2019 Daniel Hanson
-
-        Licensed under the Apache License, Version 2.0 (the "License");
-        you may not use this file except in compliance with the License.
-        You may obtain a copy of the License at
-
-                http://www.apache.org/licenses/LICENSE-2.0
-
-        Unless required by applicable law or agreed to in writing, software
-        distributed under the License is distributed on an "AS IS" BASIS,
-        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-        See the License for the specific language governing permissions and
-        limitations under the License.
-*/
+#include "qf/EuroTree.hpp"
+#include "qf/OptionType.hpp"
+#include "qf/ScenarioChunks.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using std::exp;
+using std::log;
+using std::make_tuple;
+using std::max;
+using std::min;
+using std::sqrt;
+using std::tuple;
+
+namespace {
+
+// Folds nodes [first, end) of a time step into edge, the largest -sign * spot
+// of the nodes exercised, from the spot and the value of node i: an exercised
+// node holds exactly its intrinsic value
+template <typename T, typename SpotAt, typename ValueAt>
+auto exercisedEdge(T edge, std::size_t first, std::size_t end, T sign,
+                   T strike, SpotAt spotAt, ValueAt valueAt) -> T {
+  for (std::size_t i = first; i != end; ++i) {
+    const T spot = spotAt(i);
+    const T exercise = max(sign * (spot - strike), T(0));
+    if (exercise > 0 && valueAt(i) == exercise) {
+      edge = max(edge, -sign * spot);
+    }
+  }
+  return edge;
+}
+
+// Values of the induction below the smallest normal T are flushed to zero.
+// They are the far tail of the option out of the money, which shrinks by a
+// factor of the weights every step, and on a tree of thousands of steps the
+// subnormals it turns into slow the whole induction down many times over.
+template <typename T> auto flushed(T value) -> T {
+  return value < std::numeric_limits<T>::min() ? T(0) : value;
+}
+
+// the spot of an edge, the highest exercised for a put and the lowest for a
+// call, or NaN when no node is
+template <typename T> auto criticalSpot(T edge, T sign) -> T {
+  return std::isinf(edge) ? std::numeric_limits<T>::quiet_NaN() : -sign * edge;
+}
+
+// The steps below top, down to top - numBands * tile, as a wavefront of
+// tiles of tile steps by tile nodes. Tile (band, block) starts from step
+// top - band * tile, and at its s-th step covers the nodes from
+// block * tile - (band * tile + s) * width, clamped to those of the step:
+// skewed down by the width of a step each step, so that its nodes need only
+// its own from the step before and the width below them, of the block to its
+// left. The tiles of level band + block then depend only on lower levels,
+// and neither share a node nor a step, so that each level runs across the
+// chunks at once, between two barriers; every node takes the same inputs
+// in the same order as one step at a time, so the result is the same to the
+// last bit. stepBack(j, first, end) rolls nodes [first, end) back to step j.
+// Chunk 0 runs on the calling thread, and checks control once per level,
+// reporting progress up to done; returns false if stopped, and rethrows
+// whatever control threw once every chunk has returned.
+template <typename StepBack>
+auto wavefront(std::size_t top, std::size_t numBands, std::size_t tile,
+               std::size_t width, std::size_t numChunks,
+               const PricingControl &control, double done,
+               const StepBack &stepBack) -> bool {
+  using Index = std::ptrdiff_t;
+  const std::size_t numBlocks = width * top / tile + 1;
+  const std::size_t numLevels = numBands + numBlocks - 1;
+  // nodes of the s-th step of a tile, clamped to [0, width * j]
+  auto nodes = [&](std::size_t band, std::size_t block, std::size_t s) {
+    const std::size_t j = top - band * tile - 1 - s;
+    const Index first = static_cast<Index>(block * tile) -
+                        static_cast<Index>((band * tile + s) * width);
+    const Index end = first + static_cast<Index>(tile);
+    return std::array<Index, 3>{
+        static_cast<Index>(j), std::max(first, Index{0}),
+        std::min(end, static_cast<Index>(width * j + 1))};
+  };
+  // a tile moves down by width a step, as does the top node, and only ever
+  // further out of the bottom, so it is empty if its first step is
+  auto empty = [&](std::size_t band, std::size_t block) {
+    const auto [j, first, end] = nodes(band, block, 0);
+    return first >= end;
+  };
+
+  std::barrier sync(static_cast<Index>(numChunks));
+  std::atomic<std::size_t> stopLevel = numLevels;
+  std::exception_ptr error;
+  runScenarioChunks(numChunks, numChunks, [&](std::size_t k, std::size_t,
+                                              std::size_t) {
+    for (std::size_t level = 0; level != numLevels; ++level) {
+      if (k == 0 && control.active()) {
+        // the chunks wait for chunk 0 at the barrier, so whatever control
+        // throws is held until they are all past it, and stops them there
+        try {
+          if (control.stopRequested()) {
+            stopLevel = level;
+          } else {
+            control.report({done * static_cast<double>(level) /
+                            static_cast<double>(numLevels)});
+          }
+        } catch (...) {
+          error = std::current_exception();
+          stopLevel = level;
+        }
+      }
+      sync.arrive_and_wait();
+      if (stopLevel <= level) {
+        return;
+      }
+      // the tiles that are not empty, dealt out to the chunks in turn
+      std::size_t dealt = 0;
+      const std::size_t lastBand = std::min(level, numBands - 1);
+      for (std::size_t band = level < numBlocks ? 0 : level - numBlocks + 1;
+           band <= lastBand; ++band) {
+        const std::size_t block = level - band;
+        if (empty(band, block) || dealt++ % numChunks != k) {
+          continue;
+        }
+        for (std::size_t s = 0; s != tile; ++s) {
+          const auto [j, first, end] = nodes(band, block, s);
+          if (first < end) {
+            stepBack(static_cast<std::size_t>(j),
+                     static_cast<std::size_t>(first),
+                     static_cast<std::size_t>(end));
+          }
+        }
+      }
+    }
+  });
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return stopLevel == numLevels;
+}
+
+} // namespace
+
+template <typename T>
+BasicEuroTree<T>::BasicEuroTree(T mktPrice, T mktRate, T mktVol, T divRate,
+                                T strike, T expiry, OptionType porc,
+                                int numTimePoints, LatticeSettings settings,
+                                const PricingControl &control)
+    : mktPrice_(mktPrice), mktRate_(mktRate), mktVol_(mktVol),
+      divRate_(divRate), strike_(strike), expiry_(expiry), porc_(porc),
+      numTimePoints_(numTimePoints), settings_(std::move(settings)) {
+  if (!(mktVol > 0)) {
+    throw std::invalid_argument("Volatility must be positive!");
+  }
+  for (const CashDividend &dividend : settings_.dividends) {
+    if (dividend.time <= 0 || dividend.amount < 0) {
+      throw std::invalid_argument(
+          "Cash dividends must be paid after today and be non-negative!");
+    }
+  }
+  // the other lattices oscillate with the number of steps, and Leisen-Reimer
+  // with its parity, which extrapolation only amplifies
+  if (settings_.richardson) {
+    if (settings_.lattice != LatticeType::LeisenReimer) {
+      throw std::invalid_argument(
+          "Only Leisen-Reimer lattices converge smoothly enough to "
+          "extrapolate!");
+    }
+    if (numTimePoints < 4 || numTimePoints % 2 != 0) {
+      throw std::invalid_argument(
+          "An even number of time points, at least four, required to "
+          "extrapolate!");
+    }
+  }
+  dt_ = optionPrice_ = 0;
+  calcPrice_(control);
+}
+
+template <typename T>
+auto BasicEuroTree<T>::optionPrice() const -> T { return optionPrice_; }
+
+template <typename T>
+auto BasicEuroTree<T>::calcDelta(T pctShift) const -> T {
+  if (pctShift == 0) {
+    throw std::invalid_argument(
+        "Non-zero price change required to compute delta");
+  }
+  BasicEuroTree uTree(*this); // tree if mktPrice does up
+  BasicEuroTree dTree(*this); // tree if mkrPrice does downn
+  T delta = (uTree.resetMktPrice(mktPrice_ * (1 + pctShift)) -
+             dTree.resetMktPrice(mktPrice_ * (1 - pctShift))) /
+            (2 * pctShift * mktPrice_);
+  return delta;
+}
+
+// Delta and gamma are differences across the nodes next to the root: those
+// of steps 1 and 2 of a binomial tree, or of step 1 of a trinomial one. Theta
+// is the change from the root to the value at its spot at nearStep_(), from
+// the parabola through the three nodes there; their middle one is at that
+// spot on a CRR tree without cash dividends. The four bumped trees go through
+// one call of rollBack_, or two with Richardson extrapolation.
+template <typename T>
+auto BasicEuroTree<T>::calcGreeks(T volShift, T rateShift) const -> Greeks {
+  if (numTimePoints_ < 3) {
+    throw std::invalid_argument(
+        "At least three time points required to compute Greeks!");
+  }
+  if (volShift <= 0 || rateShift <= 0 || volShift >= mktVol_) {
+    throw std::invalid_argument(
+        "Shifts must be positive, and the volatility shift below it!");
+  }
+  const std::array<T, 2> &stepOne = early_.stepOne;
+  const std::array<T, 3> &stepTwo = early_.stepTwo;
+  const std::size_t near = nearStep_();
+  const T spot = node_(0, 0);
+  const T upUp = node_(2, near);
+  const T middle = node_(1, near);
+  const T downDown = node_(0, near);
+  Greeks g;
+  g.price = optionPrice_;
+  g.delta = width_() == 1
+                ? (stepOne[1] - stepOne[0]) / (node_(1, 1) - node_(0, 1))
+                : (stepTwo[2] - stepTwo[0]) / (upUp - downDown);
+  g.gamma = ((stepTwo[2] - stepTwo[1]) / (upUp - middle) -
+             (stepTwo[1] - stepTwo[0]) / (middle - downDown)) /
+            ((upUp - downDown) / 2);
+  const T later = stepTwo[0] * (spot - middle) * (spot - upUp) /
+                      ((downDown - middle) * (downDown - upUp)) +
+                  stepTwo[1] * (spot - downDown) * (spot - upUp) /
+                      ((middle - downDown) * (middle - upUp)) +
+                  stepTwo[2] * (spot - downDown) * (spot - middle) /
+                      ((upUp - downDown) * (upUp - middle));
+  g.theta = (later - early_.root) / (static_cast<T>(near) * dt_);
+
+  auto bumped = [&](std::size_t steps) {
+    const Geometry_ volUp = geometry_(mktVol_ + volShift, mktRate_, steps);
+    const Geometry_ volDown = geometry_(mktVol_ - volShift, mktRate_, steps);
+    const Geometry_ rateUp = geometry_(mktVol_, mktRate_ + rateShift, steps);
+    const Geometry_ rateDown = geometry_(mktVol_, mktRate_ - rateShift, steps);
+    std::vector<T> values;
+    rollBack_<4>({&volUp, &volDown, &rateUp, &rateDown}, values,
+                 PricingControl{}, nullptr, nullptr);
+    values.resize(4);
+    return values;
+  };
+  std::vector<T> values = bumped(numTimePoints_ - 1);
+  if (settings_.richardson) {
+    const std::vector<T> coarse = bumped(coarseSteps_());
+    for (std::size_t k = 0; k != 4; ++k) {
+      values[k] = extrapolate_(values[k], coarse[k]);
+    }
+  }
+  g.vega = (values[0] - values[1]) / (2 * volShift);
+  g.rho = (values[2] - values[3]) / (2 * rateShift);
+  return g;
+}
+
+template <typename T>
+auto BasicEuroTree<T>::exerciseBoundary() const -> std::span<const T> {
+  return boundary_;
+}
+
+template <typename T>
+auto BasicEuroTree<T>::operator()(std::size_t i, std::size_t j) const
+    -> BasicEuroNode<T> {
+  if (!settings_.fullGrid) {
+    throw std::logic_error(
+        "The nodes are kept only with LatticeSettings::fullGrid!");
+  }
+  return grid_[i][j];
+}
+
+template <typename T>
+auto BasicEuroTree<T>::grid() const
+    -> boost::const_multi_array_ref<BasicEuroNode<T>, 2> {
+  return boost::const_multi_array_ref<BasicEuroNode<T>, 2>(
+      grid_.data(), boost::extents[grid_.shape()[0]][grid_.shape()[1]]);
+}
+
+template <typename T>
+auto BasicEuroTree<T>::resetMktPrice(T newMktPrice) -> T {
+  if (newMktPrice < 0) {
+    throw std::invalid_argument(
+        "Reset failed. Market price should be non-negative.");
+  }
+  return reset_(mktPrice_, newMktPrice);
+}
+
+template <typename T>
+auto BasicEuroTree<T>::resetMktRate(T newMktRate) -> T {
+  return reset_(mktRate_, newMktRate);
+}
+
+template <typename T>
+auto BasicEuroTree<T>::resetDivRate(T newDivRate) -> T {
+  if (newDivRate < 0) {
+    throw std::invalid_argument(
+        "Reset failed. Stock dividend should be non-negative.");
+  }
+  return reset_(divRate_, newDivRate);
+}
+
+template <typename T>
+auto BasicEuroTree<T>::resetMktVol(T newMktVol) -> T {
+  if (!(newMktVol > 0)) {
+    throw std::invalid_argument(
+        "Reset failed. Market volatility should be positive.");
+  }
+  return reset_(mktVol_, newMktVol);
+}
+
+// Reprices with one input changed. calcPrice_ throws before it touches the
+// tree when the lattice rejects the inputs, so putting the old input back
+// leaves the tree as it was.
+template <typename T>
+auto BasicEuroTree<T>::reset_(T &input, T newValue) -> T {
+  if (newValue != input) {
+    const T oldValue = std::exchange(input, newValue);
+    try {
+      calcPrice_();
+    } catch (...) {
+      input = oldValue;
+      throw;
+    }
+  }
+  return optionPrice_;
+}
+
+template <typename T>
+void BasicEuroTree<T>::calcPrice_(const PricingControl &control) {
+  // every geometry first, as they are what rejects the inputs
+  Geometry_ coarse;
+  if (settings_.richardson) {
+    coarse = geometry_(mktVol_, mktRate_, coarseSteps_());
+  }
+  paramInit_();
+  const bool boundary = settings_.exercise == ExerciseStyle::American &&
+                        settings_.exerciseBoundary;
+  if (!boundary) {
+    boundary_.clear();
+  }
+  if (settings_.fullGrid) {
+    gridSetup_();
+    projectPrices_(control);
+    calcPayoffs_(control);
+    optionPrice_ = grid_[0][0].payoff;
+  } else {
+    grid_.resize(boost::extents[0][0]);
+    rollBack_<1>({&base_}, slice_, control, &early_,
+                 boundary ? &boundary_ : nullptr);
+    optionPrice_ = slice_[0];
+  }
+  if (settings_.richardson) {
+    // a quarter of the work again, which may be stopped but reports nothing
+    std::vector<T> values;
+    rollBack_<1>({&coarse}, values, PricingControl{control.stopToken, {}},
+                 nullptr, nullptr);
+    optionPrice_ = extrapolate_(optionPrice_, values[0]);
+  }
+}
+
+template <typename T> void BasicEuroTree<T>::paramInit_() {
+  // Real yfToExpiry = dayCount_(valueDate_, expireDate_);
+  dt_ = expiry_ / static_cast<T>(numTimePoints_ - 1);
+  base_ = geometry_(mktVol_, mktRate_, numTimePoints_ - 1);
+}
+
+template <typename T> void BasicEuroTree<T>::gridSetup_() {
+  grid_.resize(
+      boost::extents[width_() * (numTimePoints_ - 1) + 1][numTimePoints_]);
+}
+
+// the forward pass is the first half of the work
+template <typename T>
+void BasicEuroTree<T>::projectPrices_(const PricingControl &control) {
+  const std::size_t width = width_();
+  for (std::size_t j = 0; j < numTimePoints_; ++j) {
+    if (control.active() && j > 0) {
+      control.throwIfStopped();
+      control.report({0.5 * static_cast<double>(j - 1) /
+                      static_cast<double>(numTimePoints_ - 1)});
+    }
+    for (std::size_t i = 0; i <= width * j; ++i) {
+      grid_[i][j].underlying = node_(i, j);
+    }
+  }
+}
+
+// the same induction as rollBack_, node by node over the grid
+template <typename T>
+void BasicEuroTree<T>::calcPayoffs_(const PricingControl &control) {
+  const std::size_t last = numTimePoints_ - 1;
+  const std::size_t width = width_();
+  const std::size_t near = nearStep_();
+  const T sign = sign_();
+  const bool american = settings_.exercise == ExerciseStyle::American;
+  const bool boundary = american && settings_.exerciseBoundary;
+  if (boundary) {
+    boundary_.assign(numTimePoints_, std::numeric_limits<T>::quiet_NaN());
+  }
+  auto keepStep = [&](std::size_t j) {
+    if (boundary) {
+      const T edge = exercisedEdge(
+          -std::numeric_limits<T>::infinity(), 0, width * j + 1, sign,
+          strike_, [&](std::size_t i) { return grid_[i][j].underlying; },
+          [&](std::size_t i) { return grid_[i][j].payoff; });
+      boundary_[j] = criticalSpot(edge, sign);
+    }
+    if (j == 0) {
+      early_.root = grid_[0][0].payoff;
+    }
+    if (j == 1 && width == 1) {
+      early_.stepOne = {grid_[0][1].payoff, grid_[1][1].payoff};
+    }
+    if (j == near) {
+      early_.stepTwo = {grid_[0][j].payoff, grid_[1][j].payoff,
+                        grid_[2][j].payoff};
+    }
+  };
+
+  for (std::size_t i = 0; i <= width * last; ++i) {
+    grid_[i][last].payoff =
+        max(sign * (grid_[i][last].underlying - strike_), T(0));
+  }
+  keepStep(last);
+  for (std::size_t j = last; j-- > 0;) {
+    if (control.active()) {
+      control.throwIfStopped();
+      control.report({1.0 - 0.5 * static_cast<double>(j + 1) /
+                                static_cast<double>(last)});
+    }
+    for (std::size_t i = 0; i <= width * j; ++i) {
+      T hold = base_.pu * grid_[i + width][j + 1].payoff +
+               base_.pd * grid_[i][j + 1].payoff;
+      if (width == 2) {
+        hold += base_.pm * grid_[i + 1][j + 1].payoff;
+      }
+      const T exercise = max(sign * (grid_[i][j].underlying - strike_), T(0));
+      grid_[i][j].payoff =
+          american ? max(flushed(hold), exercise) : flushed(hold);
+    }
+    keepStep(j);
+  }
+}
+
+// The lattice of settings_.lattice over the given number of steps to expiry.
+// The binomial ones all make the discounted spot a martingale; CRR is the one
+// of the James book, u = exp(vol sqrt(dt)) and d = 1 / u.
+template <typename T>
+auto BasicEuroTree<T>::geometry_(T vol, T rate, std::size_t steps) const
+    -> Geometry_ {
+  Geometry_ g;
+  g.steps = steps;
+  g.dt = expiry_ / static_cast<T>(steps);
+  const T dt = g.dt;
+
+  g.dividendsAhead.assign(steps + 1, T(0));
+  for (const CashDividend &dividend : settings_.dividends) {
+    const T time = static_cast<T>(dividend.time);
+    if (time > expiry_) {
+      continue;
+    }
+    for (std::size_t j = 0; j <= steps; ++j) {
+      const T now = static_cast<T>(j) * dt;
+      if (time > now) {
+        g.dividendsAhead[j] +=
+            static_cast<T>(dividend.amount) * exp(-rate * (time - now));
+      }
+    }
+  }
+  g.escrowedSpot = mktPrice_ - g.dividendsAhead[0];
+  if (g.dividendsAhead[0] > 0 && !(g.escrowedSpot > 0)) {
+    throw std::invalid_argument("Cash dividends worth more than the spot!");
+  }
+
+  const T growth = exp((rate - divRate_) * dt);
+  const T disc = exp(-rate * dt);
+  T p = 0;
+  // at a zero spot every node is 0 whatever the factors, and Leisen-Reimer
+  // has no d1 to invert
+  const LatticeType lattice =
+      settings_.lattice == LatticeType::LeisenReimer && g.escrowedSpot == 0
+          ? LatticeType::CoxRossRubinstein
+          : settings_.lattice;
+  switch (lattice) {
+  case LatticeType::CoxRossRubinstein: {
+    const T volSqrtDt = vol * sqrt(dt);
+    const T up = exp(volSqrtDt);
+    const T down = 1 / up;
+    p = (growth - down) / (up - down);
+    g.logDown = -volSqrtDt;
+    g.logRatio = 2 * volSqrtDt;
+    break;
+  }
+  case LatticeType::LeisenReimer: {
+    // Peizer-Pratt method 2, the probability of at least (n + 1) / 2 of n
+    // steps up that converges on N(z)
+    const T n = static_cast<T>(steps);
+    auto inversion = [n](T z) {
+      const T a = z / (n + T(1) / 3 + T(0.1) / (n + 1));
+      return T(0.5) +
+             std::copysign(T(0.5), z) * sqrt(1 - exp(-a * a * (n + T(1) / 6)));
+    };
+    const T volSqrtT = vol * sqrt(expiry_);
+    const T d1 = (log(g.escrowedSpot / strike_) +
+                  (rate - divRate_ + vol * vol / 2) * expiry_) /
+                 volSqrtT;
+    p = inversion(d1 - volSqrtT);
+    const T up = growth * inversion(d1) / p;
+    const T down = (growth - p * up) / (1 - p);
+    g.logDown = log(down);
+    g.logRatio = log(up) - g.logDown;
+    break;
+  }
+  case LatticeType::Tian: {
+    // v - 1 with expm1, which matters for small steps in float
+    const T w = std::expm1(vol * vol * dt);
+    const T root = sqrt(w * (w + 4));
+    const T up = growth * (1 + w) / 2 * (w + 2 + root);
+    const T down = growth * (1 + w) / 2 * (w + 2 - root);
+    p = (growth - down) / (up - down);
+    g.logDown = log(down);
+    g.logRatio = log(up) - g.logDown;
+    break;
+  }
+  case LatticeType::Trinomial: {
+    // the moments of the log of the spot over a step
+    const T dx = vol * sqrt(3 * dt);
+    const T nu = rate - divRate_ - vol * vol / 2;
+    const T spread = (vol * vol * dt + nu * nu * dt * dt) / (dx * dx);
+    const T drift = nu * dt / dx;
+    const T up = (spread + drift) / 2;
+    const T down = (spread - drift) / 2;
+    if (!(up >= 0 && down >= 0 && spread <= 1)) {
+      throw std::invalid_argument(
+          "Lattice probabilities outside [0, 1]; use more time points!");
+    }
+    g.pu = disc * up;
+    g.pm = disc * (1 - spread);
+    g.pd = disc * down;
+    g.logDown = -dx;
+    g.logRatio = dx;
+    return g;
+  }
+  }
+  if (!(p >= 0 && p <= 1)) {
+    throw std::invalid_argument(
+        "Lattice probabilities outside [0, 1]; use more time points!");
+  }
+  g.pu = disc * p;
+  g.pm = 0;
+  g.pd = disc * (1 - p);
+  return g;
+}
+
+// Rolls K trees of the same steps back together, one per geometry, into
+// values[k]. Value i of a slice is node i of the current step; going back a
+// step, value i takes in values i to i + width, so the slice is overwritten
+// from the bottom up. The K slices are interleaved, value i of tree k at
+// values[i * K + k], so that every node is one packed update of all K trees.
+// The spot of node i of step j is escrowedSpot d^j (u/d)^i plus the dividends
+// ahead, from one exp per step and a table of (u/d)^i, and American exercise
+// floors the continuation value at the intrinsic one with a max: the inner
+// loops have no branch and run over contiguous arrays. With runParallel most
+// steps go through wavefront() instead, in tiles that stay in cache. Control,
+// early and boundary (either may be null) follow tree 0.
+template <typename T>
+template <std::size_t K>
+void BasicEuroTree<T>::rollBack_(const std::array<const Geometry_ *, K> &lanes,
+                                 std::vector<T> &values,
+                                 const PricingControl &control,
+                                 EarlySteps_ *early,
+                                 std::vector<T> *boundary) const {
+  const std::size_t last = lanes[0]->steps;
+  const std::size_t width = width_();
+  const std::size_t near = nearStep_();
+  const std::size_t numNodes = width * last + 1;
+  const T sign = sign_();
+  const T strike = strike_;
+  const bool american = settings_.exercise == ExerciseStyle::American;
+  std::array<T, K> pu{};
+  std::array<T, K> pm{};
+  std::array<T, K> pd{};
+  std::vector<T> growth(numNodes * K);
+  for (std::size_t k = 0; k != K; ++k) {
+    pu[k] = lanes[k]->pu;
+    pm[k] = lanes[k]->pm;
+    pd[k] = lanes[k]->pd;
+    for (std::size_t i = 0; i != numNodes; ++i) {
+      growth[i * K + k] = exp(static_cast<T>(i) * lanes[k]->logRatio);
+    }
+  }
+  // the spot of node i of step j in tree k is lowest[k] growth[i * K + k]
+  // plus ahead[k]; a Step is only ever copied, never referred to, so that it
+  // stays in registers and the American loop still vectorises
+  struct Step {
+    std::array<T, K> lowest{};
+    std::array<T, K> ahead{};
+  };
+  auto stepAt = [&](std::size_t j) {
+    Step step;
+    for (std::size_t k = 0; k != K; ++k) {
+      step.lowest[k] =
+          lanes[k]->escrowedSpot * exp(static_cast<T>(j) * lanes[k]->logDown);
+      step.ahead[k] = lanes[k]->dividendsAhead[j];
+    }
+    return step;
+  };
+  // until the end, the largest -sign * spot exercised at each step
+  if (boundary != nullptr) {
+    boundary->assign(last + 1, -std::numeric_limits<T>::infinity());
+  }
+  values.resize(numNodes * K);
+  T *v = values.data();
+  const T *g = growth.data();
+  // one step back over nodes [first, end) of step j, from the W nodes
+  // further up of step j + 1
+  auto induct = [&](auto nodesPerStep, Step step, std::size_t first,
+                    std::size_t end) {
+    constexpr std::size_t W = decltype(nodesPerStep)::value;
+    if (american) {
+      for (std::size_t i = first; i < end; ++i) {
+        for (std::size_t k = 0; k != K; ++k) {
+          T hold = pu[k] * v[(i + W) * K + k] + pd[k] * v[i * K + k];
+          if constexpr (W == 2) {
+            hold += pm[k] * v[(i + 1) * K + k];
+          }
+          const T spot = step.lowest[k] * g[i * K + k] + step.ahead[k];
+          v[i * K + k] = max(flushed(hold), max(sign * (spot - strike), T(0)));
+        }
+      }
+    } else {
+      for (std::size_t i = first; i < end; ++i) {
+        for (std::size_t k = 0; k != K; ++k) {
+          T hold = pu[k] * v[(i + W) * K + k] + pd[k] * v[i * K + k];
+          if constexpr (W == 2) {
+            hold += pm[k] * v[(i + 1) * K + k];
+          }
+          v[i * K + k] = flushed(hold);
+        }
+      }
+    }
+  };
+  // nodes [first, end) of step j, which may run at once with other steps
+  auto stepBack = [&](std::size_t j, std::size_t first, std::size_t end) {
+    const Step step = stepAt(j);
+    if (width == 1) {
+      induct(std::integral_constant<std::size_t, 1>{}, step, first, end);
+    } else {
+      induct(std::integral_constant<std::size_t, 2>{}, step, first, end);
+    }
+    if (boundary != nullptr) {
+      (*boundary)[j] = exercisedEdge(
+          (*boundary)[j], first, end, sign, strike,
+          [step, g](std::size_t i) {
+            return step.lowest[0] * g[i * K] + step.ahead[0];
+          },
+          [v](std::size_t i) { return v[i * K]; });
+    }
+  };
+  auto keepEarly = [&](std::size_t j) {
+    if (early == nullptr) {
+      return;
+    }
+    if (j == 0) {
+      early->root = v[0];
+    }
+    if (j == 1 && width == 1) {
+      early->stepOne = {v[0], v[K]};
+    }
+    if (j == near) {
+      early->stepTwo = {v[0], v[K], v[2 * K]};
+    }
+  };
+
+  const Step expiry = stepAt(last);
+  for (std::size_t i = 0; i != numNodes; ++i) {
+    for (std::size_t k = 0; k != K; ++k) {
+      const T spot = expiry.lowest[k] * g[i * K + k] + expiry.ahead[k];
+      v[i * K + k] = max(sign * (spot - strike), T(0));
+    }
+  }
+  if (boundary != nullptr) {
+    (*boundary)[last] = exercisedEdge(
+        (*boundary)[last], 0, numNodes, sign, strike,
+        [expiry, g](std::size_t i) {
+          return expiry.lowest[0] * g[i * K] + expiry.ahead[0];
+        },
+        [v](std::size_t i) { return v[i * K]; });
+  }
+  keepEarly(last);
+
+  // With runParallel, the steps go through the wavefront in bands of tile
+  // steps for as long as whole bands fit above step 3, and the rest one at a
+  // time. A tile is at most 4096 values of the slice and as many of growth,
+  // which fit in L2, and smaller on smaller trees so that the widest level
+  // still has four tiles a chunk.
+  std::size_t j = last;
+  if (settings_.runParallel) {
+    const std::size_t numChunks = numScenarioChunks(numNodes / 1024);
+    const std::size_t tile =
+        std::clamp(numNodes / (4 * numChunks), std::size_t{64}, 4096 / K);
+    const std::size_t numBands = last > 3 ? (last - 3) / tile : 0;
+    if (numBands > 0) {
+      const double done = static_cast<double>(numBands * tile) /
+                          static_cast<double>(last);
+      if (!wavefront(last, numBands, tile, width, numChunks, control, done,
+                     stepBack)) {
+        control.throwIfStopped();
+      }
+      j -= numBands * tile;
+    }
+  }
+  while (j-- > 0) {
+    if (control.active()) {
+      control.throwIfStopped();
+      control.report({1.0 - static_cast<double>(j + 1) /
+                                static_cast<double>(last)});
+    }
+    stepBack(j, 0, width * j + 1);
+    keepEarly(j);
+  }
+  if (boundary != nullptr) {
+    for (T &edge : *boundary) {
+      edge = criticalSpot(edge, sign);
+    }
+  }
+}
+
+// escrowedSpot d^j (u/d)^i plus the dividends ahead, computed exactly as in
+// rollBack_, so that both modes give the same price to the last bit; one exp
+// each rather than a chain of products, whose rounding grows with the steps
+template <typename T>
+auto BasicEuroTree<T>::node_(std::size_t i, std::size_t j) const -> T {
+  const T lowest = base_.escrowedSpot * exp(static_cast<T>(j) * base_.logDown);
+  return lowest * exp(static_cast<T>(i) * base_.logRatio) +
+         base_.dividendsAhead[j];
+}
+
+template <typename T> auto BasicEuroTree<T>::sign_() const -> T {
+  return porc_ == OptionType::Call ? T(1) : T(-1);
+}
+
+template <typename T> auto BasicEuroTree<T>::width_() const -> std::size_t {
+  return settings_.lattice == LatticeType::Trinomial ? 2 : 1;
+}
+
+template <typename T> auto BasicEuroTree<T>::nearStep_() const -> std::size_t {
+  return width_() == 1 ? 2 : 1;
+}
+
+// About half the steps, and an odd number of them like the fine tree, as
+// Leisen-Reimer converges smoothly over odd numbers of steps only
+template <typename T>
+auto BasicEuroTree<T>::coarseSteps_() const -> std::size_t {
+  return (numTimePoints_ - 1) / 2 | 1;
+}
+
+// With an error of c / n^order after n steps, the two prices give c and the
+// limit. Leisen-Reimer converges at order 2 on a European option, and at
+// order 1 on an American one: the early exercise boundary falls between
+// nodes wherever it falls.
+template <typename T>
+auto BasicEuroTree<T>::extrapolate_(T fine, T coarse) const -> T {
+  const T order = settings_.exercise == ExerciseStyle::European ? 2 : 1;
+  const T n = std::pow(static_cast<T>(numTimePoints_ - 1), order);
+  const T m = std::pow(static_cast<T>(coarseSteps_()), order);
+  return fine + (fine - coarse) * m / (n - m);
+}
+
+template class BasicEuroTree<float>;
+template class BasicEuroTree<double>;
+
+/*
+        Copyright 2019 Daniel Hanson
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+*/
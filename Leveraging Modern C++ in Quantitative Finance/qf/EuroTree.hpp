@@ -1,76 +1,167 @@
-#ifndef QF_EUROTREE_HPP
-#define QF_EUROTREE_HPP
-
-#include "qf/EuroNode.hpp"
-#include "qf/OptionType.hpp"
-
-#include <boost/multi_array.hpp>
-
-class EuroTree {
-public:
-  EuroTree(Real mktPrice, Real mktRate, Real mktVol, Real divRate, Real strike,
-           Real expiry, OptionType porc, int numTimePoints);
-
-  auto resetMktPrice(Real newMktPrice) -> Real;
-  auto resetMktRate(Real newMktRate) -> Real;
-  auto resetDivRate(Real newDivRate) -> Real;
-  auto resetMktVol(Real newMktVol) -> Real;
-
-  [[nodiscard]] auto optionPrice() const -> Real;
-  [[nodiscard]] auto calcDelta(Real pctShift = 0.0001) const -> Real;
-
-  // Accessors:
-  [[nodiscard]] auto operator()(std::size_t i, std::size_t j) const -> EuroNode;
-  [[nodiscard]] auto grid() const -> boost::multi_array<EuroNode, 2>;
-
-private:
-  // Mkt Data:
-  Real mktPrice_; // Market price for underlying security
-  Real mktRate_;  // Risk-free rate
-  Real mktVol_;   // Volatility
-
-  // Product/Contract Data:
-  Real divRate_;    // Dividend rate
-  Real strike_;     // Strike price
-  Real expiry_;     // Time to expiration as a year fraction
-  OptionType porc_; // Put or Call enum class
-
-  // Model Settings:
-  std::size_t numTimePoints_;
-  // const DayCount& dayCount_;
-  // Stored as reference to handle polymorphic object
-
-  // Calculated member variables:
-  boost::multi_array<EuroNode, 2> grid_;
-  Real dt_, u_, d_, p_; // delta t, u, d, and p parameters, a la James book
-  Real discFctr_;    // Discount factor (fixed for each time step, a la James)
-  Real optionPrice_; // Store result as member
-
-  // 5th Real value will be time value (replaces two dates)
-  std::tuple<Real, Real, Real, Real, Real, OptionType, int> data_;
-
-  // Helper functions:
-  void calcPrice_(); // This function refactors the next five into one call
-  void gridSetup_();
-  void paramInit_(); // Determine delta t, u, d, and p, a la James book
-  void projectPrices_();
-  void calcPayoffs_();
-};
-
-#endif // QF_EUROTREE_HPP
-
-/*
-        Copyright 2019 Daniel Hanson
-
-        Licensed under the Apache License, Version 2.0 (the "License");
-        you may not use this file except in compliance with the License.
-        You may obtain a copy of the License at
-
-                http://www.apache.org/licenses/LICENSE-2.0
-
-        Unless required by applicable law or agreed to in writing, software
-        distributed under the License is distributed on an "AS IS" BASIS,
-        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-        See the License for the specific language governing permissions and
-        limitations under the License.
-*/
+#ifndef QF_EUROTREE_HPP
+#define QF_EUROTREE_HPP
+
+#include "qf/AsyncPricing.hpp"
+#include "qf/EuroNode.hpp"
+#include "qf/Greeks.hpp"
+#include "qf/LatticeSettings.hpp"
+#include "qf/OptionType.hpp"
+
+#include <array>
+#include <boost/multi_array.hpp>
+#include <span>
+#include <vector>
+
+// Binomial tree of a European option with every value of type T, e.g. float
+// or double, or of an American one with LatticeSettings::exercise; the
+// lattice is CRR unless LatticeSettings::lattice picks another, trinomial
+// included. By default the price comes from one time slice of numTimePoints
+// values rolled back in place, so memory grows linearly with the steps and a
+// tree of 10k steps fits in L2; LatticeSettings::fullGrid keeps the whole
+// lattice for inspection.
+template <typename T> class BasicEuroTree {
+public:
+  BasicEuroTree(T mktPrice, T mktRate, T mktVol, T divRate, T strike,
+                T expiry, OptionType porc, int numTimePoints,
+                LatticeSettings settings = {},
+                const PricingControl &control = {});
+
+  auto resetMktPrice(T newMktPrice) -> T;
+  auto resetMktRate(T newMktRate) -> T;
+  auto resetDivRate(T newDivRate) -> T;
+  auto resetMktVol(T newMktVol) -> T;
+
+  [[nodiscard]] auto optionPrice() const -> T;
+  // delta by repricing at the spot moved by pctShift either way; small
+  // shifts pick up the oscillation of the lattice, which calcGreeks() avoids
+  [[nodiscard]] auto calcDelta(T pctShift = 0.0001) const -> T;
+
+  // Greeks of one unit, with the conventions of Greeks.hpp. Delta, gamma and
+  // theta are read off the nodes next to the root in the pricing induction,
+  // at no extra cost; vega and rho are central differences over volShift and
+  // rateShift, from four bumped trees rolled back together in one pass over
+  // interleaved slices, and extrapolated like the price. Needs at least three
+  // time points.
+  [[nodiscard]] auto calcGreeks(T volShift = 0.001, T rateShift = 0.001) const
+      -> Greeks;
+
+  // With American exercise and LatticeSettings::exerciseBoundary, the
+  // critical spot of each time step: the highest node at which a put is
+  // exercised, or the lowest for a call, and NaN where none is; empty
+  // otherwise
+  [[nodiscard]] auto exerciseBoundary() const -> std::span<const T>;
+
+  // Accessors, for a tree built with LatticeSettings::fullGrid: node i of
+  // time step j, for i up to j, or 2j on a trinomial lattice, which throws
+  // std::logic_error otherwise, and a view of the
+  // whole grid, which is then empty. The view is into the tree, so it lasts
+  // until the tree is reset or destroyed.
+  [[nodiscard]] auto operator()(std::size_t i, std::size_t j) const
+      -> BasicEuroNode<T>;
+  [[nodiscard]] auto grid() const
+      -> boost::const_multi_array_ref<BasicEuroNode<T>, 2>;
+
+private:
+  // Mkt Data:
+  T mktPrice_; // Market price for underlying security
+  T mktRate_;  // Risk-free rate
+  T mktVol_;   // Volatility
+
+  // Product/Contract Data:
+  T divRate_;       // Dividend rate
+  T strike_;        // Strike price
+  T expiry_;        // Time to expiration as a year fraction
+  OptionType porc_; // Put or Call enum class
+
+  // Model Settings:
+  std::size_t numTimePoints_;
+  LatticeSettings settings_;
+  // const DayCount& dayCount_;
+  // Stored as reference to handle polymorphic object
+
+  // Calculated member variables:
+  // What the induction needs of the volatility, rate and number of steps: the
+  // discounted weights of a step up, across (trinomial only) and down, the
+  // log of the lowest factor and of the ratio of neighbouring nodes, and the
+  // spot less the present value of the cash dividends, with the value at
+  // step j of those paid after it
+  struct Geometry_ {
+    std::size_t steps;
+    T dt;
+    T pu;
+    T pm;
+    T pd;
+    T logDown;
+    T logRatio;
+    T escrowedSpot;
+    std::vector<T> dividendsAhead;
+  };
+  // for calcGreeks, values at the two nodes of step 1 of a binomial tree, at
+  // the three nodes of nearStep_(), and at the root before extrapolation
+  struct EarlySteps_ {
+    std::array<T, 2> stepOne{};
+    std::array<T, 3> stepTwo{};
+    T root{};
+  };
+
+  boost::multi_array<BasicEuroNode<T>, 2> grid_; // only with fullGrid
+  std::vector<T> slice_; // the time slice rolled back without fullGrid
+  std::vector<T> boundary_;
+  EarlySteps_ early_;
+  Geometry_ base_;
+  T dt_;          // delta t, a la James book
+  T optionPrice_; // Store result as member
+
+  // 5th T value will be time value (replaces two dates)
+  std::tuple<T, T, T, T, T, OptionType, int> data_;
+
+  // Helper functions:
+  // This function refactors the next four into one call; control is checked
+  // and told of the progress once per time step
+  void calcPrice_(const PricingControl &control = {});
+  auto reset_(T &input, T newValue) -> T; // calcPrice_ with input newValue
+  void gridSetup_();
+  void paramInit_(); // Determine delta t and base_, a la James book
+  void projectPrices_(const PricingControl &control);
+  void calcPayoffs_(const PricingControl &control);
+  [[nodiscard]] auto geometry_(T vol, T rate, std::size_t steps) const
+      -> Geometry_;
+  // Rolls one tree per geometry back to its root at values[k]; see the .cpp
+  template <std::size_t K>
+  void rollBack_(const std::array<const Geometry_ *, K> &lanes,
+                 std::vector<T> &values, const PricingControl &control,
+                 EarlySteps_ *early, std::vector<T> *boundary) const;
+  [[nodiscard]] auto node_(std::size_t i, std::size_t j) const -> T;
+  [[nodiscard]] auto sign_() const -> T; // 1 for a call, -1 for a put
+  // nodes added by each step, 1 on a binomial lattice and 2 on a trinomial
+  [[nodiscard]] auto width_() const -> std::size_t;
+  // the first step with three nodes: 2, or 1 on a trinomial lattice
+  [[nodiscard]] auto nearStep_() const -> std::size_t;
+  // Richardson extrapolation from the prices of the tree and of one of
+  // coarseSteps_() steps, given how fast the lattice converges
+  [[nodiscard]] auto coarseSteps_() const -> std::size_t;
+  [[nodiscard]] auto extrapolate_(T fine, T coarse) const -> T;
+};
+
+extern template class BasicEuroTree<float>;
+extern template class BasicEuroTree<double>;
+
+using EuroTree = BasicEuroTree<Real>;
+
+#endif // QF_EUROTREE_HPP
+
+/*
+        Copyright 2019 Daniel Hanson
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+*/
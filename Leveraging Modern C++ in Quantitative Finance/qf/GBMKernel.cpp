@@ -0,0 +1,540 @@
+#include "qf/GBMKernel.hpp"
+#include "qf/LaneMath.hpp"
+#include "qf/Philox.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+using qf::lanes::expLanes;
+using qf::lanes::logLanes;
+using qf::lanes::sinCosTwoPi;
+
+constexpr std::size_t W = gbmBatchWidth;
+using Lanes = std::array<Real, W>;
+using FloatLanes = std::array<float, W>;
+
+struct KeySchedule {
+  std::array<std::uint32_t, 10> k0;
+  std::array<std::uint32_t, 10> k1;
+};
+
+auto keySchedule(std::uint64_t seed) -> KeySchedule {
+  Philox4x32::Key key = Philox4x32::key(seed);
+  KeySchedule ks{};
+  for (std::size_t round = 0; round != 10; ++round) {
+    ks.k0[round] = key[0] + static_cast<std::uint32_t>(round) * 0x9E3779B9;
+    ks.k1[round] = key[1] + static_cast<std::uint32_t>(round) * 0xBB67AE85;
+  }
+  return ks;
+}
+
+// Philox4x32-10 block (n, stream + l) of every lane l; u1 in (0, 1] and u2 in
+// [0, 1) are built from the two 64-bit halves exactly as in
+// PhiloxNormalGenerator
+QF_KERNEL_INLINE void philoxUniforms(const KeySchedule &ks, std::uint64_t n,
+                                     std::uint64_t stream, Lanes &u1,
+                                     Lanes &u2) {
+  for (std::size_t l = 0; l != W; ++l) {
+    std::uint32_t c0 = static_cast<std::uint32_t>(n);
+    std::uint32_t c1 = static_cast<std::uint32_t>(n >> 32);
+    std::uint32_t c2 = static_cast<std::uint32_t>(stream + l);
+    std::uint32_t c3 = static_cast<std::uint32_t>((stream + l) >> 32);
+    for (std::size_t round = 0; round != 10; ++round) {
+      std::uint64_t p0 = std::uint64_t{0xD2511F53} * c0;
+      std::uint64_t p1 = std::uint64_t{0xCD9E8D57} * c2;
+      c0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ ks.k0[round];
+      c1 = static_cast<std::uint32_t>(p1);
+      c2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ ks.k1[round];
+      c3 = static_cast<std::uint32_t>(p0);
+    }
+    std::uint64_t w0 = (std::uint64_t{c1} << 32) | c0;
+    std::uint64_t w1 = (std::uint64_t{c3} << 32) | c2;
+    u1[l] = 2.0 - std::bit_cast<Real>((w0 >> 12) | 0x3FF0000000000000);
+    u2[l] = std::bit_cast<Real>((w1 >> 12) | 0x3FF0000000000000) - 1.0;
+  }
+}
+
+// the same block for float lanes: each 32-bit word gives a 24-bit uniform,
+// u1a and u1b in (0, 1], u2a and u2b in [0, 1)
+QF_KERNEL_INLINE void philoxUniforms(const KeySchedule &ks, std::uint64_t n,
+                                     std::uint64_t stream, FloatLanes &u1a,
+                                     FloatLanes &u2a, FloatLanes &u1b,
+                                     FloatLanes &u2b) {
+  auto uniform = [](std::uint32_t word) {
+    return static_cast<float>(static_cast<std::int32_t>(word >> 8)) * 0x1p-24F;
+  };
+  for (std::size_t l = 0; l != W; ++l) {
+    std::uint32_t c0 = static_cast<std::uint32_t>(n);
+    std::uint32_t c1 = static_cast<std::uint32_t>(n >> 32);
+    std::uint32_t c2 = static_cast<std::uint32_t>(stream + l);
+    std::uint32_t c3 = static_cast<std::uint32_t>((stream + l) >> 32);
+    for (std::size_t round = 0; round != 10; ++round) {
+      std::uint64_t p0 = std::uint64_t{0xD2511F53} * c0;
+      std::uint64_t p1 = std::uint64_t{0xCD9E8D57} * c2;
+      c0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ ks.k0[round];
+      c1 = static_cast<std::uint32_t>(p1);
+      c2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ ks.k1[round];
+      c3 = static_cast<std::uint32_t>(p0);
+    }
+    u1a[l] = uniform(c0) + 0x1p-24F;
+    u2a[l] = uniform(c1);
+    u1b[l] = uniform(c2) + 0x1p-24F;
+    u2b[l] = uniform(c3);
+  }
+}
+
+// gbmBatchWidth paths from stream firstStream on, each normal pair of a
+// Philox block feeding two consecutive steps of the log-price; Mirrored also
+// yields the antithetic paths, driven by the same normals with flipped sign
+template <bool Mirrored>
+QF_KERNEL_INLINE void terminalBlock(const GBMStepParams &params,
+                                    const KeySchedule &ks,
+                                    std::uint64_t firstStream, Real *out,
+                                    Real *mirroredOut) {
+  Lanes logPrice{};
+  Lanes mirroredLogPrice{};
+  Lanes u1, u2, c, s;
+  const std::size_t numBlocks = (params.numTimeSteps + 1) / 2;
+  for (std::size_t n = 0; n != numBlocks; ++n) {
+    philoxUniforms(ks, n, firstStream, u1, u2);
+    logLanes(u1);
+    sinCosTwoPi(u2, c, s);
+    // the second normal of the last block is unused for odd numTimeSteps
+    const Real second = 2 * n + 1 < params.numTimeSteps ? 1.0 : 0.0;
+    for (std::size_t l = 0; l != W; ++l) {
+      Real radius = std::sqrt(-2.0 * u1[l]);
+      Real shock0 = params.diffusionTerm * (radius * c[l]);
+      Real shock1 = params.diffusionTerm * (radius * s[l]);
+      logPrice[l] += params.driftTerm + shock0;
+      logPrice[l] += second * (params.driftTerm + shock1);
+      if constexpr (Mirrored) {
+        mirroredLogPrice[l] += params.driftTerm - shock0;
+        mirroredLogPrice[l] += second * (params.driftTerm - shock1);
+      }
+    }
+  }
+  expLanes(logPrice);
+  for (std::size_t l = 0; l != W; ++l) {
+    out[l] = params.initPrice * logPrice[l];
+  }
+  if constexpr (Mirrored) {
+    expLanes(mirroredLogPrice);
+    for (std::size_t l = 0; l != W; ++l) {
+      mirroredOut[l] = params.initPrice * mirroredLogPrice[l];
+    }
+  }
+}
+
+// the float paths take four steps from each Philox block; as the drift is
+// the same at every step, only the sum of the normals is kept, and the
+// mirrored path is the same sum with the opposite sign
+template <bool Mirrored>
+QF_KERNEL_INLINE void terminalBlock(const BasicGBMStepParams<float> &params,
+                                    const KeySchedule &ks,
+                                    std::uint64_t firstStream, float *out,
+                                    float *mirroredOut) {
+  FloatLanes sum{};
+  FloatLanes u1a, u2a, u1b, u2b, ca, sa, cb, sb;
+  const std::size_t numSteps = params.numTimeSteps;
+  const std::size_t numBlocks = (numSteps + 3) / 4;
+  for (std::size_t n = 0; n != numBlocks; ++n) {
+    philoxUniforms(ks, n, firstStream, u1a, u2a, u1b, u2b);
+    logLanes(u1a);
+    logLanes(u1b);
+    sinCosTwoPi(u2a, ca, sa);
+    sinCosTwoPi(u2b, cb, sb);
+    // the last block may leave some of its four normals unused
+    const float w1 = 4 * n + 1 < numSteps ? 1.0F : 0.0F;
+    const float w2 = 4 * n + 2 < numSteps ? 1.0F : 0.0F;
+    const float w3 = 4 * n + 3 < numSteps ? 1.0F : 0.0F;
+    for (std::size_t l = 0; l != W; ++l) {
+      float ra = std::sqrt(-2.0F * u1a[l]);
+      float rb = std::sqrt(-2.0F * u1b[l]);
+      sum[l] += ra * (ca[l] + w1 * sa[l]) + rb * (w2 * cb[l] + w3 * sb[l]);
+    }
+  }
+  const float drift = static_cast<float>(numSteps) * params.driftTerm;
+  FloatLanes logPrice;
+  FloatLanes mirroredLogPrice;
+  for (std::size_t l = 0; l != W; ++l) {
+    logPrice[l] = drift + params.diffusionTerm * sum[l];
+    mirroredLogPrice[l] = drift - params.diffusionTerm * sum[l];
+  }
+  expLanes(logPrice);
+  for (std::size_t l = 0; l != W; ++l) {
+    out[l] = params.initPrice * logPrice[l];
+  }
+  if constexpr (Mirrored) {
+    expLanes(mirroredLogPrice);
+    for (std::size_t l = 0; l != W; ++l) {
+      mirroredOut[l] = params.initPrice * mirroredLogPrice[l];
+    }
+  }
+}
+
+template <bool Mirrored, typename T>
+QF_KERNEL_INLINE void terminalPricesImpl(const BasicGBMStepParams<T> &params,
+                                         std::uint64_t seed,
+                                         std::uint64_t firstStream,
+                                         std::span<T> out,
+                                         std::span<T> mirroredOut) {
+  const KeySchedule ks = keySchedule(seed);
+  std::size_t i = 0;
+  // without Mirrored, mirroredOut is empty and may not be offset
+  for (; i + W <= out.size(); i += W) {
+    terminalBlock<Mirrored>(params, ks, firstStream + i, out.data() + i,
+                            Mirrored ? mirroredOut.data() + i : nullptr);
+  }
+  if (i != out.size()) {
+    std::array<T, W> tail;
+    std::array<T, W> mirroredTail;
+    terminalBlock<Mirrored>(params, ks, firstStream + i, tail.data(),
+                            mirroredTail.data());
+    std::copy_n(tail.begin(), out.size() - i, out.begin() + i);
+    if constexpr (Mirrored) {
+      std::copy_n(mirroredTail.begin(), out.size() - i,
+                  mirroredOut.begin() + i);
+    }
+  }
+}
+
+template <typename T>
+QF_KERNEL_INLINE void terminalPricesAny(const BasicGBMStepParams<T> &params,
+                                        std::uint64_t seed,
+                                        std::uint64_t firstStream,
+                                        std::span<T> out,
+                                        std::span<T> mirroredOut) {
+  if (mirroredOut.empty()) {
+    terminalPricesImpl<false>(params, seed, firstStream, out, mirroredOut);
+  } else {
+    terminalPricesImpl<true>(params, seed, firstStream, out, mirroredOut);
+  }
+}
+
+void terminalPricesScalar(const GBMStepParams &params, std::uint64_t seed,
+                          std::uint64_t firstStream, std::span<Real> out,
+                          std::span<Real> mirroredOut) {
+  terminalPricesAny(params, seed, firstStream, out, mirroredOut);
+}
+
+void terminalPricesScalar(const BasicGBMStepParams<float> &params,
+                          std::uint64_t seed, std::uint64_t firstStream,
+                          std::span<float> out, std::span<float> mirroredOut) {
+  terminalPricesAny(params, seed, firstStream, out, mirroredOut);
+}
+
+#ifdef QF_MULTIVERSION
+__attribute__((target("avx2,fma"))) void
+terminalPricesAVX2(const GBMStepParams &params, std::uint64_t seed,
+                   std::uint64_t firstStream, std::span<Real> out,
+                   std::span<Real> mirroredOut) {
+  terminalPricesAny(params, seed, firstStream, out, mirroredOut);
+}
+
+__attribute__((target("avx2,fma"))) void
+terminalPricesAVX2(const BasicGBMStepParams<float> &params,
+                   std::uint64_t seed, std::uint64_t firstStream,
+                   std::span<float> out, std::span<float> mirroredOut) {
+  terminalPricesAny(params, seed, firstStream, out, mirroredOut);
+}
+
+__attribute__((target("avx512f,avx512dq"))) void
+terminalPricesAVX512(const GBMStepParams &params, std::uint64_t seed,
+                     std::uint64_t firstStream, std::span<Real> out,
+                     std::span<Real> mirroredOut) {
+  terminalPricesAny(params, seed, firstStream, out, mirroredOut);
+}
+
+__attribute__((target("avx512f,avx512dq"))) void
+terminalPricesAVX512(const BasicGBMStepParams<float> &params,
+                     std::uint64_t seed, std::uint64_t firstStream,
+                     std::span<float> out, std::span<float> mirroredOut) {
+  terminalPricesAny(params, seed, firstStream, out, mirroredOut);
+}
+#endif
+
+// the public entry points of both precisions
+template <typename T>
+void terminalPrices(SimdLevel level, const BasicGBMStepParams<T> &params,
+                    std::uint64_t seed, std::uint64_t firstStream,
+                    std::span<T> out, std::span<T> mirroredOut) {
+  switch (level) {
+#ifdef QF_MULTIVERSION
+  case SimdLevel::AVX512:
+    terminalPricesAVX512(params, seed, firstStream, out, mirroredOut);
+    break;
+  case SimdLevel::AVX2:
+    terminalPricesAVX2(params, seed, firstStream, out, mirroredOut);
+    break;
+#endif
+  default:
+    terminalPricesScalar(params, seed, firstStream, out, mirroredOut);
+    break;
+  }
+}
+
+// w = L z for the lower-triangular factor L of numAssets rows, row-major with
+// zeros above the diagonal, and lanes of normals z; four rows at a time, so
+// each lane vector of z loaded feeds four accumulators
+QF_KERNEL_INLINE void choleskyLanes(std::span<const Real> cholesky,
+                                    std::size_t numAssets, const Lanes *z,
+                                    Lanes *w) {
+  std::size_t i = 0;
+  for (; i + 4 <= numAssets; i += 4) {
+    Lanes a0{}, a1{}, a2{}, a3{};
+    const Real *row = cholesky.data() + i * numAssets;
+    for (std::size_t j = 0; j != i + 4; ++j) {
+      const Real l0 = row[j];
+      const Real l1 = row[numAssets + j];
+      const Real l2 = row[2 * numAssets + j];
+      const Real l3 = row[3 * numAssets + j];
+      for (std::size_t l = 0; l != W; ++l) {
+        a0[l] += l0 * z[j][l];
+        a1[l] += l1 * z[j][l];
+        a2[l] += l2 * z[j][l];
+        a3[l] += l3 * z[j][l];
+      }
+    }
+    w[i] = a0;
+    w[i + 1] = a1;
+    w[i + 2] = a2;
+    w[i + 3] = a3;
+  }
+  for (; i != numAssets; ++i) {
+    Lanes a{};
+    const Real *row = cholesky.data() + i * numAssets;
+    for (std::size_t j = 0; j != i + 1; ++j) {
+      for (std::size_t l = 0; l != W; ++l) {
+        a[l] += row[j] * z[j][l];
+      }
+    }
+    w[i] = a;
+  }
+}
+
+// gbmBatchWidth correlated multi-asset paths from stream firstStream on.
+// Each step draws the normals of all assets, correlates them and moves every
+// log-price; FullPath writes the prices after every step, in [step][asset]
+// [lane] order, otherwise only those after the last one, in [asset][lane]
+// order. Mirrored also yields the paths of the negated normals. scratch holds
+// the normals, their correlated mix and the log-prices, correlatedLanes() of
+// them.
+template <bool Mirrored, bool FullPath>
+QF_KERNEL_INLINE void correlatedBlock(const CorrelatedGBMParams &params,
+                                      std::uint64_t seed,
+                                      std::uint64_t firstStream, Real *out,
+                                      Real *mirroredOut,
+                                      std::span<Lanes> scratch) {
+  const KeySchedule ks = keySchedule(seed);
+  const std::size_t numAssets = params.initPrices.size();
+  const std::size_t numPairs = (numAssets + 1) / 2;
+  Lanes *z = scratch.data();
+  Lanes *w = z + 2 * numPairs;
+  Lanes *logPrice = w + numAssets;
+  Lanes *mirroredLogPrice = logPrice + numAssets;
+  std::fill_n(logPrice, Mirrored ? 2 * numAssets : numAssets, Lanes{});
+  Lanes u1, u2, c, s, prices;
+
+  auto store = [&](const Lanes *logs, Real *dest) {
+    for (std::size_t i = 0; i != numAssets; ++i) {
+      prices = logs[i];
+      expLanes(prices);
+      for (std::size_t l = 0; l != W; ++l) {
+        dest[i * W + l] = params.initPrices[i] * prices[l];
+      }
+    }
+  };
+  if constexpr (FullPath) {
+    store(logPrice, out);
+    if constexpr (Mirrored) {
+      store(mirroredLogPrice, mirroredOut);
+    }
+  }
+
+  for (std::size_t step = 0; step != params.numTimeSteps; ++step) {
+    for (std::size_t pair = 0; pair != numPairs; ++pair) {
+      philoxUniforms(ks, step * numPairs + pair, firstStream, u1, u2);
+      logLanes(u1);
+      sinCosTwoPi(u2, c, s);
+      // kept a loop, which GCC vectorizes; through scratch pointers it would
+      // otherwise unroll it in full and leave it scalar
+#pragma GCC unroll 1
+      for (std::size_t l = 0; l != W; ++l) {
+        Real radius = std::sqrt(-2.0 * u1[l]);
+        z[2 * pair][l] = radius * c[l];
+        z[2 * pair + 1][l] = radius * s[l];
+      }
+    }
+    choleskyLanes(params.cholesky, numAssets, z, w);
+    for (std::size_t i = 0; i != numAssets; ++i) {
+      const Real drift = params.driftTerms[i];
+      const Real diffusion = params.diffusionTerms[i];
+      // kept a loop, as above
+#pragma GCC unroll 1
+      for (std::size_t l = 0; l != W; ++l) {
+        logPrice[i][l] += drift + diffusion * w[i][l];
+        if constexpr (Mirrored) {
+          mirroredLogPrice[i][l] += drift - diffusion * w[i][l];
+        }
+      }
+    }
+    if constexpr (FullPath) {
+      const std::size_t offset = (step + 1) * numAssets * W;
+      store(logPrice, out + offset);
+      if constexpr (Mirrored) {
+        store(mirroredLogPrice, mirroredOut + offset);
+      }
+    }
+  }
+
+  if constexpr (!FullPath) {
+    store(logPrice, out);
+    if constexpr (Mirrored) {
+      store(mirroredLogPrice, mirroredOut);
+    }
+  }
+}
+
+// lanes of scratch that correlatedBlock takes for numAssets assets
+constexpr auto correlatedLanes(std::size_t numAssets) -> std::size_t {
+  return (numAssets + 1) / 2 * 2 + 3 * numAssets;
+}
+
+// the scratch of a block lives on the stack up to this many assets, so that a
+// batch of a basket takes no allocation
+constexpr std::size_t maxStackAssets = 32;
+
+QF_KERNEL_INLINE void correlatedAny(const CorrelatedGBMParams &params,
+                                    std::uint64_t seed,
+                                    std::uint64_t firstStream, bool fullPath,
+                                    std::span<Real> out,
+                                    std::span<Real> mirroredOut) {
+  Real *o = out.data();
+  Real *m = mirroredOut.data();
+  const std::size_t numLanes = correlatedLanes(params.initPrices.size());
+  std::array<Lanes, correlatedLanes(maxStackAssets)> stackScratch;
+  std::vector<Lanes> heapScratch(
+      numLanes > stackScratch.size() ? numLanes : 0);
+  const std::span<Lanes> scratch =
+      heapScratch.empty() ? std::span<Lanes>(stackScratch).first(numLanes)
+                          : std::span<Lanes>(heapScratch);
+  if (fullPath) {
+    if (mirroredOut.empty()) {
+      correlatedBlock<false, true>(params, seed, firstStream, o, m, scratch);
+    } else {
+      correlatedBlock<true, true>(params, seed, firstStream, o, m, scratch);
+    }
+  } else {
+    if (mirroredOut.empty()) {
+      correlatedBlock<false, false>(params, seed, firstStream, o, m, scratch);
+    } else {
+      correlatedBlock<true, false>(params, seed, firstStream, o, m, scratch);
+    }
+  }
+}
+
+void correlatedScalar(const CorrelatedGBMParams &params, std::uint64_t seed,
+                      std::uint64_t firstStream, bool fullPath,
+                      std::span<Real> out, std::span<Real> mirroredOut) {
+  correlatedAny(params, seed, firstStream, fullPath, out, mirroredOut);
+}
+
+#ifdef QF_MULTIVERSION
+__attribute__((target("avx2,fma"))) void
+correlatedAVX2(const CorrelatedGBMParams &params, std::uint64_t seed,
+               std::uint64_t firstStream, bool fullPath, std::span<Real> out,
+               std::span<Real> mirroredOut) {
+  correlatedAny(params, seed, firstStream, fullPath, out, mirroredOut);
+}
+
+__attribute__((target("avx512f,avx512dq"))) void
+correlatedAVX512(const CorrelatedGBMParams &params, std::uint64_t seed,
+                 std::uint64_t firstStream, bool fullPath,
+                 std::span<Real> out, std::span<Real> mirroredOut) {
+  correlatedAny(params, seed, firstStream, fullPath, out, mirroredOut);
+}
+#endif
+
+void correlated(const CorrelatedGBMParams &params, std::uint64_t seed,
+                std::uint64_t firstStream, bool fullPath, std::span<Real> out,
+                std::span<Real> mirroredOut) {
+  switch (gbmSimdLevel()) {
+#ifdef QF_MULTIVERSION
+  case SimdLevel::AVX512:
+    correlatedAVX512(params, seed, firstStream, fullPath, out, mirroredOut);
+    break;
+  case SimdLevel::AVX2:
+    correlatedAVX2(params, seed, firstStream, fullPath, out, mirroredOut);
+    break;
+#endif
+  default:
+    correlatedScalar(params, seed, firstStream, fullPath, out, mirroredOut);
+    break;
+  }
+}
+
+} // namespace
+
+auto gbmSimdLevel() -> SimdLevel {
+#ifdef QF_MULTIVERSION
+  static const SimdLevel level = []() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") &&
+        __builtin_cpu_supports("avx512dq")) {
+      return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+      return SimdLevel::AVX2;
+    }
+    return SimdLevel::Scalar;
+  }();
+  return level;
+#else
+  return SimdLevel::Scalar;
+#endif
+}
+
+void gbmTerminalPrices(const GBMStepParams &params, std::uint64_t seed,
+                       std::uint64_t firstStream, std::span<Real> out,
+                       std::span<Real> mirroredOut) {
+  gbmTerminalPrices(gbmSimdLevel(), params, seed, firstStream, out,
+                    mirroredOut);
+}
+
+void gbmTerminalPrices(SimdLevel level, const GBMStepParams &params,
+                       std::uint64_t seed, std::uint64_t firstStream,
+                       std::span<Real> out, std::span<Real> mirroredOut) {
+  terminalPrices(level, params, seed, firstStream, out, mirroredOut);
+}
+
+void gbmTerminalPrices(const BasicGBMStepParams<float> &params,
+                       std::uint64_t seed, std::uint64_t firstStream,
+                       std::span<float> out, std::span<float> mirroredOut) {
+  gbmTerminalPrices(gbmSimdLevel(), params, seed, firstStream, out,
+                    mirroredOut);
+}
+
+void gbmTerminalPrices(SimdLevel level,
+                       const BasicGBMStepParams<float> &params,
+                       std::uint64_t seed, std::uint64_t firstStream,
+                       std::span<float> out, std::span<float> mirroredOut) {
+  terminalPrices(level, params, seed, firstStream, out, mirroredOut);
+}
+
+void gbmCorrelatedPaths(const CorrelatedGBMParams &params, std::uint64_t seed,
+                        std::uint64_t firstStream, std::span<Real> out,
+                        std::span<Real> mirroredOut) {
+  correlated(params, seed, firstStream, true, out, mirroredOut);
+}
+
+void gbmCorrelatedTerminalPrices(const CorrelatedGBMParams &params,
+                                 std::uint64_t seed, std::uint64_t firstStream,
+                                 std::span<Real> out,
+                                 std::span<Real> mirroredOut) {
+  correlated(params, seed, firstStream, false, out, mirroredOut);
+}
@@ -0,0 +1,18 @@
+#ifndef QF_GREEKS_HPP
+#define QF_GREEKS_HPP
+
+using Real = double;
+
+// Price of an option position with its sensitivities: delta and gamma to the
+// spot price, vega to the volatility, theta to the passage of calendar time
+// (per year) and rho to the risk-free rate
+struct Greeks {
+  Real price = 0.0;
+  Real delta = 0.0;
+  Real gamma = 0.0;
+  Real vega = 0.0;
+  Real theta = 0.0;
+  Real rho = 0.0;
+};
+
+#endif // QF_GREEKS_HPP
@@ -0,0 +1,298 @@
+#ifndef QF_LANEMATH_HPP
+#define QF_LANEMATH_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+
+// GCC and Clang on x86 compile the SIMD kernels once per instruction set and
+// pick one at runtime; elsewhere only the portable build exists
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QF_MULTIVERSION
+#define QF_KERNEL_INLINE [[gnu::always_inline]] inline
+#else
+#define QF_KERNEL_INLINE inline
+#endif
+
+// Elementary functions of the SIMD kernels. Every helper works lane by lane
+// over fixed-size arrays and has no data-dependent branch, so each loop
+// vectorises with the instruction set of the kernel it is inlined into.
+namespace qf::lanes {
+
+inline constexpr double ln2Hi = 6.93147180369123816490e-01; // low 32 bits 0
+inline constexpr double ln2Lo = 1.90821492927058770002e-10;
+// x + roundMagic - roundMagic rounds x
+inline constexpr double roundMagic = 0x1.8p52;
+
+inline constexpr float ln2HiF = 0x1.62e4p-1F; // low 8 bits are zero
+inline constexpr float ln2LoF = 1.42860677e-06F;
+inline constexpr float roundMagicF = 0x1.8p23F;
+
+// log(x) for positive normal x: x = 2^e * m with m in [sqrt(1/2), sqrt(2)),
+// log(m) = 2 atanh(s) with s = (m - 1) / (m + 1) by its Taylor series; the
+// offset moves sqrt(1/2) to the bottom of a binade so e and m need no select
+template <std::size_t N>
+QF_KERNEL_INLINE void logLanes(std::array<double, N> &x) {
+  constexpr std::uint64_t offset =
+      0x3FF0000000000000 -
+      std::bit_cast<std::uint64_t>(0.5 * std::numbers::sqrt2);
+  for (std::size_t l = 0; l != N; ++l) {
+    std::uint64_t bits = std::bit_cast<std::uint64_t>(x[l]);
+    std::uint64_t shifted = bits + offset;
+    double e = std::bit_cast<double>((shifted >> 52) | 0x4330000000000000) -
+               (0x1p52 + 1023.0);
+    double m = std::bit_cast<double>(bits - (shifted & 0xFFF0000000000000) +
+                                     0x3FF0000000000000);
+    double s = (m - 1.0) / (m + 1.0);
+    double z = s * s;
+    double p = 2.0 / 21.0;
+    p = 2.0 / 19.0 + z * p;
+    p = 2.0 / 17.0 + z * p;
+    p = 2.0 / 15.0 + z * p;
+    p = 2.0 / 13.0 + z * p;
+    p = 2.0 / 11.0 + z * p;
+    p = 2.0 / 9.0 + z * p;
+    p = 2.0 / 7.0 + z * p;
+    p = 2.0 / 5.0 + z * p;
+    p = 2.0 / 3.0 + z * p;
+    double logm = 2.0 * s + s * z * p;
+    x[l] = e * ln2Hi + (logm + e * ln2Lo);
+  }
+}
+
+template <std::size_t N>
+QF_KERNEL_INLINE void logLanes(std::array<float, N> &x) {
+  constexpr std::uint32_t offset =
+      0x3F800000 -
+      std::bit_cast<std::uint32_t>(std::numbers::sqrt2_v<float> / 2);
+  for (std::size_t l = 0; l != N; ++l) {
+    std::uint32_t bits = std::bit_cast<std::uint32_t>(x[l]);
+    std::uint32_t shifted = bits + offset;
+    float e = std::bit_cast<float>((shifted >> 23) | 0x4B000000) -
+              (0x1p23F + 127.0F);
+    float m = std::bit_cast<float>(bits - (shifted & 0xFF800000) + 0x3F800000);
+    float s = (m - 1.0F) / (m + 1.0F);
+    float z = s * s;
+    float p = 2.0F / 11.0F;
+    p = 2.0F / 9.0F + z * p;
+    p = 2.0F / 7.0F + z * p;
+    p = 2.0F / 5.0F + z * p;
+    p = 2.0F / 3.0F + z * p;
+    float logm = 2.0F * s + s * z * p;
+    x[l] = e * ln2HiF + (logm + e * ln2LoF);
+  }
+}
+
+// cos(2 pi u) and sin(2 pi u): 4u = n + f with integer n and |f| <= 1/2, the
+// Taylor series run on x = f pi / 2 and the quadrant n mod 4 swaps and flips
+template <std::size_t N>
+QF_KERNEL_INLINE void sinCosTwoPi(const std::array<double, N> &u,
+                                  std::array<double, N> &c,
+                                  std::array<double, N> &s) {
+  for (std::size_t l = 0; l != N; ++l) {
+    double t = 4.0 * u[l];
+    double shifted = t + roundMagic;
+    std::uint64_t q = std::bit_cast<std::uint64_t>(shifted);
+    double x = (t - (shifted - roundMagic)) * (std::numbers::pi / 2.0);
+    double x2 = x * x;
+    double ps = 1.0 / 355687428096000.0;
+    ps = -1.0 / 1307674368000.0 + x2 * ps;
+    ps = 1.0 / 6227020800.0 + x2 * ps;
+    ps = -1.0 / 39916800.0 + x2 * ps;
+    ps = 1.0 / 362880.0 + x2 * ps;
+    ps = -1.0 / 5040.0 + x2 * ps;
+    ps = 1.0 / 120.0 + x2 * ps;
+    ps = -1.0 / 6.0 + x2 * ps;
+    double sinx = x + x * x2 * ps;
+    double pc = -1.0 / 6402373705728000.0;
+    pc = 1.0 / 20922789888000.0 + x2 * pc;
+    pc = -1.0 / 87178291200.0 + x2 * pc;
+    pc = 1.0 / 479001600.0 + x2 * pc;
+    pc = -1.0 / 3628800.0 + x2 * pc;
+    pc = 1.0 / 40320.0 + x2 * pc;
+    pc = -1.0 / 720.0 + x2 * pc;
+    pc = 1.0 / 24.0 + x2 * pc;
+    double cosx = 1.0 - 0.5 * x2 + x2 * x2 * pc;
+    std::uint64_t sinBits = std::bit_cast<std::uint64_t>(sinx);
+    std::uint64_t cosBits = std::bit_cast<std::uint64_t>(cosx);
+    std::uint64_t swap = 0 - (q & 1); // all ones in odd quadrants
+    std::uint64_t cq = (sinBits & swap) | (cosBits & ~swap);
+    std::uint64_t sq = (cosBits & swap) | (sinBits & ~swap);
+    c[l] = std::bit_cast<double>(cq ^ (((q + 1) & 2) << 62));
+    s[l] = std::bit_cast<double>(sq ^ ((q & 2) << 62));
+  }
+}
+
+template <std::size_t N>
+QF_KERNEL_INLINE void sinCosTwoPi(const std::array<float, N> &u,
+                                  std::array<float, N> &c,
+                                  std::array<float, N> &s) {
+  for (std::size_t l = 0; l != N; ++l) {
+    float t = 4.0F * u[l];
+    float shifted = t + roundMagicF;
+    std::uint32_t q = std::bit_cast<std::uint32_t>(shifted);
+    float x = (t - (shifted - roundMagicF)) *
+              static_cast<float>(std::numbers::pi / 2.0);
+    float x2 = x * x;
+    float ps = 1.0F / 362880.0F;
+    ps = -1.0F / 5040.0F + x2 * ps;
+    ps = 1.0F / 120.0F + x2 * ps;
+    ps = -1.0F / 6.0F + x2 * ps;
+    float sinx = x + x * x2 * ps;
+    float pc = -1.0F / 3628800.0F;
+    pc = 1.0F / 40320.0F + x2 * pc;
+    pc = -1.0F / 720.0F + x2 * pc;
+    pc = 1.0F / 24.0F + x2 * pc;
+    float cosx = 1.0F - 0.5F * x2 + x2 * x2 * pc;
+    std::uint32_t sinBits = std::bit_cast<std::uint32_t>(sinx);
+    std::uint32_t cosBits = std::bit_cast<std::uint32_t>(cosx);
+    std::uint32_t swap = 0 - (q & 1);
+    std::uint32_t cq = (sinBits & swap) | (cosBits & ~swap);
+    std::uint32_t sq = (cosBits & swap) | (sinBits & ~swap);
+    c[l] = std::bit_cast<float>(cq ^ (((q + 1) & 2) << 30));
+    s[l] = std::bit_cast<float>(sq ^ ((q & 2) << 30));
+  }
+}
+
+// exp(x) = 2^k exp(r) with k = round(x / ln 2) and |r| <= ln(2) / 2
+QF_KERNEL_INLINE auto expReduced(double r, std::uint64_t kBits) -> double {
+  double p = 1.0 / 6227020800.0;
+  p = 1.0 / 479001600.0 + r * p;
+  p = 1.0 / 39916800.0 + r * p;
+  p = 1.0 / 3628800.0 + r * p;
+  p = 1.0 / 362880.0 + r * p;
+  p = 1.0 / 40320.0 + r * p;
+  p = 1.0 / 5040.0 + r * p;
+  p = 1.0 / 720.0 + r * p;
+  p = 1.0 / 120.0 + r * p;
+  p = 1.0 / 24.0 + r * p;
+  p = 1.0 / 6.0 + r * p;
+  p = 0.5 + r * p;
+  p = 1.0 + r * p;
+  p = 1.0 + r * p;
+  return p * std::bit_cast<double>((kBits + 1023) << 52);
+}
+
+template <std::size_t N>
+QF_KERNEL_INLINE void expLanes(std::array<double, N> &x) {
+  for (std::size_t l = 0; l != N; ++l) {
+    double v = x[l];
+    v = v < -708.0 ? -708.0 : v;
+    v = v > 709.0 ? 709.0 : v;
+    double shifted = v * std::numbers::log2e + roundMagic;
+    std::uint64_t kBits = std::bit_cast<std::uint64_t>(shifted);
+    double k = shifted - roundMagic;
+    x[l] = expReduced((v - k * ln2Hi) - k * ln2Lo, kBits);
+  }
+}
+
+// exp(x + y) without rounding x + y first, for an x exact but large, such as
+// the square -z^2 of a split z, and a moderate y
+template <std::size_t N>
+QF_KERNEL_INLINE void expLanes(std::array<double, N> &x,
+                               const std::array<double, N> &y) {
+  for (std::size_t l = 0; l != N; ++l) {
+    double v = x[l] + y[l];
+    double clamped = v < -708.0 ? -708.0 : v;
+    clamped = clamped > 709.0 ? 709.0 : clamped;
+    double shifted = clamped * std::numbers::log2e + roundMagic;
+    std::uint64_t kBits = std::bit_cast<std::uint64_t>(shifted);
+    double k = shifted - roundMagic;
+    double r = v == clamped ? ((x[l] - k * ln2Hi) + y[l]) - k * ln2Lo
+                            : (clamped - k * ln2Hi) - k * ln2Lo;
+    x[l] = expReduced(r, kBits);
+  }
+}
+
+template <std::size_t N>
+QF_KERNEL_INLINE void expLanes(std::array<float, N> &x) {
+  for (std::size_t l = 0; l != N; ++l) {
+    float v = x[l];
+    v = v < -87.0F ? -87.0F : v;
+    v = v > 88.0F ? 88.0F : v;
+    float shifted = v * std::numbers::log2e_v<float> + roundMagicF;
+    std::uint32_t kBits = std::bit_cast<std::uint32_t>(shifted);
+    float k = shifted - roundMagicF;
+    float r = (v - k * ln2HiF) - k * ln2LoF;
+    float p = 1.0F / 5040.0F;
+    p = 1.0F / 720.0F + r * p;
+    p = 1.0F / 120.0F + r * p;
+    p = 1.0F / 24.0F + r * p;
+    p = 1.0F / 6.0F + r * p;
+    p = 0.5F + r * p;
+    p = 1.0F + r * p;
+    p = 1.0F + r * p;
+    x[l] = p * std::bit_cast<float>((kBits + 127) << 23);
+  }
+}
+
+// Chebyshev coefficients of log(erfc(z) / t) + z^2 in t = 2 / (2 + z), from
+// Numerical Recipes, 3rd edition, section 6.2.2
+inline constexpr std::array<double, 28> erfcCheb{
+    -1.3026537197817094,  6.4196979235649026e-1, 1.9476473204185836e-2,
+    -9.561514786808631e-3, -9.46595344482036e-4, 3.66839497852761e-4,
+    4.2523324806907e-5,   -2.0278578112534e-5,  -1.624290004647e-6,
+    1.303655835580e-6,    1.5626441722e-8,      -8.5238095915e-8,
+    6.529054439e-9,       5.059343495e-9,       -9.91364156e-10,
+    -2.27365122e-10,      9.6467911e-11,        2.394038e-12,
+    -6.886027e-12,        8.94487e-13,          3.13092e-13,
+    -1.12708e-13,         3.81e-16,             7.106e-15,
+    -1.523e-15,           -9.4e-17,             1.21e-16,
+    -2.8e-17};
+
+// erfc(z) for z >= 0 by a single Chebyshev series, so there is no range to
+// select; z is split in halves of 26 bits so that z^2 is exact in the
+// exponent. Relative error about 1e-15; z above 40, infinity included, is
+// taken as 40, where erfc is far below the smallest double.
+template <std::size_t N>
+QF_KERNEL_INLINE void erfcLanes(std::array<double, N> &z) {
+  std::array<double, N> t;
+  std::array<double, N> ty;
+  std::array<double, N> d{};
+  std::array<double, N> dd{};
+  for (std::size_t l = 0; l != N; ++l) {
+    z[l] = z[l] > 40.0 ? 40.0 : z[l];
+    t[l] = 2.0 / (2.0 + z[l]);
+    ty[l] = 4.0 * t[l] - 2.0;
+  }
+  // Clenshaw's recurrence, all lanes in step
+  for (std::size_t j = erfcCheb.size() - 1; j != 0; --j) {
+    for (std::size_t l = 0; l != N; ++l) {
+      double tmp = d[l];
+      d[l] = ty[l] * d[l] - dd[l] + erfcCheb[j];
+      dd[l] = tmp;
+    }
+  }
+  std::array<double, N> rest;
+  for (std::size_t l = 0; l != N; ++l) {
+    double c = z[l] * 134217729.0; // 2^27 + 1
+    double hi = c - (c - z[l]);
+    double lo = z[l] - hi;
+    rest[l] = -(z[l] + hi) * lo + 0.5 * (erfcCheb[0] + ty[l] * d[l]) - dd[l];
+    z[l] = -hi * hi;
+  }
+  expLanes(z, rest);
+  for (std::size_t l = 0; l != N; ++l) {
+    z[l] *= t[l];
+  }
+}
+
+// standard normal distribution function, erfc(-x / sqrt(2)) / 2 taken from
+// the side of the smaller tail
+template <std::size_t N>
+QF_KERNEL_INLINE void normalCdfLanes(std::array<double, N> &x) {
+  std::array<double, N> tail;
+  for (std::size_t l = 0; l != N; ++l) {
+    tail[l] = (x[l] < 0.0 ? -x[l] : x[l]) * std::numbers::sqrt2 / 2.0;
+  }
+  erfcLanes(tail);
+  for (std::size_t l = 0; l != N; ++l) {
+    x[l] = x[l] < 0.0 ? 0.5 * tail[l] : 1.0 - 0.5 * tail[l];
+  }
+}
+
+} // namespace qf::lanes
+
+#endif // QF_LANEMATH_HPP
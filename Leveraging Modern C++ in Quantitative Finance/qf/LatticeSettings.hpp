@@ -0,0 +1,78 @@
+#ifndef QF_LATTICESETTINGS_HPP
+#define QF_LATTICESETTINGS_HPP
+
+#include <vector>
+
+using Real = double;
+
+// When the holder may exercise
+enum class ExerciseStyle {
+  European, // at expiry only
+  American  // at any time step up to expiry
+};
+
+// How the spot moves over one step of the lattice
+enum class LatticeType {
+  // u = exp(vol sqrt(dt)) and d = 1 / u; converges at 1 / n, oscillating
+  CoxRossRubinstein,
+  // centred on the strike, from Peizer-Pratt inversions of d1 and d2 of
+  // Black-Scholes; converges at 1 / n^2 for odd numbers of steps n, so with
+  // numTimePoints even (Leisen and Reimer, Applied Math. Finance 3, 1996)
+  LeisenReimer,
+  // matches the first three moments of the spot over a step (Tian, J. Futures
+  // Markets 13, 1993)
+  Tian,
+  // up, across or down by vol sqrt(3 dt) in the log of the spot, with 2j + 1
+  // nodes at step j; converges at 1 / n with less oscillation than CRR
+  Trinomial
+};
+
+// A cash dividend of amount paid time years from now; the lattice node at
+// exactly that time is already ex-dividend
+struct CashDividend {
+  Real time = 0.0;
+  Real amount = 0.0;
+
+  friend auto operator==(const CashDividend &, const CashDividend &)
+      -> bool = default;
+};
+
+// Optional model settings of EuroTree; the defaults price with a single time
+// slice of the lattice, rolled back in place
+struct LatticeSettings {
+  // keep every node of the lattice, underlying and payoff, for operator()
+  // and grid(); it takes numTimePoints^2 nodes where pricing alone takes
+  // numTimePoints values, so it is meant for diagnostics and small trees
+  bool fullGrid = false;
+
+  ExerciseStyle exercise = ExerciseStyle::European;
+
+  // Cash dividends up to expiry, in any order, on top of the continuous
+  // dividend rate. They follow the escrowed-dividend model: the lattice is
+  // built on the spot less their present value, which is added back at each
+  // node for the dividends still to come, so the tree still recombines.
+  std::vector<CashDividend> dividends{};
+
+  // with American exercise, record the spot at which exercise starts at
+  // each time step, for EuroTree::exerciseBoundary()
+  bool exerciseBoundary = false;
+
+  LatticeType lattice = LatticeType::CoxRossRubinstein;
+
+  // price also with about half the steps and extrapolate the two prices to
+  // infinitely many, by the order at which the lattice converges; only for
+  // Leisen-Reimer with numTimePoints even, as every other lattice oscillates
+  // with the number of steps, and EuroTree throws std::invalid_argument
+  // otherwise
+  bool richardson = false;
+
+  // roll the slice back in cache-sized tiles, as a wavefront across one
+  // thread per core, to the same price as one step at a time; for trees of
+  // thousands of steps, and without fullGrid
+  bool runParallel = false;
+
+  friend auto operator==(const LatticeSettings &, const LatticeSettings &)
+      -> bool = default;
+};
+
+#endif // QF_LATTICESETTINGS_HPP
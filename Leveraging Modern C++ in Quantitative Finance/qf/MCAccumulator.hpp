@@ -0,0 +1,112 @@
+#ifndef QF_MCACCUMULATOR_HPP
+#define QF_MCACCUMULATOR_HPP
+
+#include "qf/BinaryIO.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+
+using Real = double;
+
+// Running moments over the scenarios of a Monte-Carlo simulation: the
+// sampled value y (a discounted payoff) and a control variate x drawn
+// alongside it, whose expectation is known. Means and centred sums of squares
+// and cross products are updated one sample at a time (Welford), so the
+// variance stays accurate however large the mean, and accumulators of
+// disjoint scenario ranges are combined with merge() (Chan et al.), so every
+// worker can keep its own and the estimate can be read off between batches.
+class MCAccumulator {
+public:
+  void add(Real y, Real x = 0.0) {
+    ++count_;
+    const Real weight = 1.0 / static_cast<Real>(count_);
+    const Real dy = y - meanY_;
+    const Real dx = x - meanX_;
+    meanY_ += dy * weight;
+    meanX_ += dx * weight;
+    const Real ry = y - meanY_;
+    m2Y_ += dy * ry;
+    m2X_ += dx * (x - meanX_);
+    coXY_ += dx * ry;
+  }
+
+  void merge(const MCAccumulator &other) {
+    if (other.count_ == 0) {
+      return;
+    }
+    if (count_ == 0) {
+      *this = other;
+      return;
+    }
+    const Real na = static_cast<Real>(count_);
+    const Real nb = static_cast<Real>(other.count_);
+    const Real n = na + nb;
+    const Real dy = other.meanY_ - meanY_;
+    const Real dx = other.meanX_ - meanX_;
+    const Real cross = na * nb / n;
+    m2Y_ += other.m2Y_ + dy * dy * cross;
+    m2X_ += other.m2X_ + dx * dx * cross;
+    coXY_ += other.coXY_ + dx * dy * cross;
+    meanY_ += dy * nb / n;
+    meanX_ += dx * nb / n;
+    count_ += other.count_;
+  }
+
+  [[nodiscard]] auto count() const -> std::size_t { return count_; }
+
+  // the count and moments in binary, for partial results saved to disk
+  void write(std::ostream &out) const {
+    writeBinary(out, static_cast<std::uint64_t>(count_));
+    for (Real moment : {meanY_, meanX_, m2Y_, m2X_, coXY_}) {
+      writeBinary(out, moment);
+    }
+  }
+  void read(std::istream &in) {
+    std::uint64_t count = 0;
+    readBinary(in, count);
+    count_ = static_cast<std::size_t>(count);
+    for (Real *moment : {&meanY_, &meanX_, &m2Y_, &m2X_, &coXY_}) {
+      readBinary(in, *moment);
+    }
+  }
+
+  // sample mean of y and its standard error
+  [[nodiscard]] auto mean() const -> Real {
+    return count_ > 0 ? meanY_ : std::numeric_limits<Real>::quiet_NaN();
+  }
+  [[nodiscard]] auto standardError() const -> Real {
+    return std::sqrt(std::max(m2Y_, 0.0) / (n_() - 1) / n_());
+  }
+
+  // control-variate estimate ybar - b * (xbar - controlMean), with b the
+  // regression coefficient of y on x, and its standard error from the
+  // residual variance
+  [[nodiscard]] auto controlledMean(Real controlMean) const -> Real {
+    return mean() - beta_() * (meanX_ - controlMean);
+  }
+  [[nodiscard]] auto controlledStandardError() const -> Real {
+    Real residual = m2Y_ - beta_() * coXY_;
+    return std::sqrt(std::max(residual, 0.0) / (n_() - 2) / n_());
+  }
+
+private:
+  [[nodiscard]] auto n_() const -> Real { return static_cast<Real>(count_); }
+  // a constant control carries no information and gets no weight
+  [[nodiscard]] auto beta_() const -> Real {
+    return m2X_ > 0.0 ? coXY_ / m2X_ : 0.0;
+  }
+
+  std::size_t count_ = 0;
+  Real meanY_ = 0.0;
+  Real meanX_ = 0.0;
+  Real m2Y_ = 0.0;
+  Real m2X_ = 0.0;
+  Real coXY_ = 0.0;
+};
+
+#endif // QF_MCACCUMULATOR_HPP
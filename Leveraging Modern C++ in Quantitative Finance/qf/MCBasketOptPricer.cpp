@@ -0,0 +1,137 @@
+#include "qf/MCBasketOptPricer.hpp"
+#include "qf/BlockReduction.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+auto spreadPayoff(std::size_t numAssets, std::size_t first,
+                  std::size_t second, Real strike, OptionType porc)
+    -> BasketPayoff {
+  if (first >= numAssets || second >= numAssets || first == second) {
+    throw std::invalid_argument("A spread needs two distinct assets!");
+  }
+  std::vector<Real> weights(numAssets, 0.0);
+  weights[first] = 1.0;
+  weights[second] = -1.0;
+  return {std::move(weights), strike, porc};
+}
+
+namespace {
+
+// the exact scheme reaches expiry in one log-normal step
+auto numSimulatedSteps(std::size_t numTimeSteps, const MCSettings &settings)
+    -> std::size_t {
+  return settings.pathScheme == PathScheme::Exact ? 1 : numTimeSteps;
+}
+
+} // namespace
+
+MCBasketOptPricer::MCBasketOptPricer(
+    std::vector<Real> spots, const std::vector<Real> &volatilities,
+    const std::vector<Real> &correlation, Real riskFreeRate,
+    Real timeToExpiry, BasketPayoff payoff, std::size_t numTimeSteps,
+    std::size_t numScenarios, bool runParallel, int initSeed, Real quantity,
+    MCSettings settings)
+    : generator_(spots, numSimulatedSteps(numTimeSteps, settings),
+                 timeToExpiry, riskFreeRate, volatilities, correlation),
+      riskFreeRate_(riskFreeRate), timeToExpiry_(timeToExpiry),
+      payoff_(std::move(payoff)), numScenarios_(numScenarios),
+      runParallel_(runParallel), initSeed_(initSeed), quantity_(quantity),
+      settings_(settings) {
+  if (payoff_.weights.size() != spots.size()) {
+    throw std::invalid_argument("One basket weight per asset is needed!");
+  }
+  if (settings_.randomEngine != RandomEngine::Philox) {
+    throw std::invalid_argument("Basket paths draw from Philox streams only!");
+  }
+  discFactor_ = std::exp(-riskFreeRate_ * timeToExpiry_);
+  spotBasket_ = std::inner_product(spots.begin(), spots.end(),
+                                   payoff_.weights.begin(), 0.0);
+  price_ = 0.0;
+  standardError_ = 0.0;
+  time_ = 0.0;
+  calculate_();
+}
+
+auto MCBasketOptPricer::optionPrice() const -> Real { return price_; }
+
+auto MCBasketOptPricer::standardError() const -> Real {
+  return standardError_;
+}
+
+auto MCBasketOptPricer::operator()() const -> Real {
+  return this->optionPrice();
+}
+
+auto MCBasketOptPricer::time() const -> Real { return time_; }
+
+void MCBasketOptPricer::calculate_() {
+  auto b = std::chrono::steady_clock::now();
+  computePrice_();
+  auto e = std::chrono::steady_clock::now();
+  time_ = static_cast<Real>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(e - b).count());
+}
+
+// private helper functions
+
+void MCBasketOptPricer::computePrice_() {
+  MCAccumulator acc = reduceScenarios(
+      numScenarios_, runParallel_, [&](std::size_t first, std::size_t last) {
+        return accumulate_(first, last);
+      });
+
+  if (settings_.controlVariate) {
+    price_ = quantity_ * acc.controlledMean(spotBasket_);
+    standardError_ = std::abs(quantity_) * acc.controlledStandardError();
+  } else {
+    price_ = quantity_ * acc.mean();
+    standardError_ = std::abs(quantity_) * acc.standardError();
+  }
+}
+
+// discounted payoffs of scenarios [first, last), a block of paths at a time;
+// the basket of every path of the block is summed asset by asset, so the
+// inner loop runs over contiguous paths
+auto MCBasketOptPricer::accumulate_(std::size_t first, std::size_t last) const
+    -> MCAccumulator {
+  constexpr std::size_t W = MultiAssetPriceGenerator::blockWidth;
+  const std::size_t numAssets = generator_.numAssets();
+  const bool antithetic = settings_.antithetic;
+  const auto seed = static_cast<std::uint64_t>(initSeed_);
+  const Real sign = payoff_.porc == OptionType::Call ? 1.0 : -1.0;
+
+  std::vector<Real> prices(numAssets * W);
+  std::vector<Real> mirroredPrices(antithetic ? numAssets * W : 0);
+  auto basket = [&](const std::vector<Real> &block) {
+    std::array<Real, W> sum{};
+    for (std::size_t i = 0; i != numAssets; ++i) {
+      const Real weight = payoff_.weights[i];
+      for (std::size_t l = 0; l != W; ++l) {
+        sum[l] += weight * block[i * W + l];
+      }
+    }
+    return sum;
+  };
+
+  MCAccumulator acc;
+  for (std::size_t i = first; i < last; i += W) {
+    generator_.terminalPrices(seed, i, prices, mirroredPrices);
+    const auto value = basket(prices);
+    const auto mirroredValue = antithetic ? basket(mirroredPrices) : value;
+    const std::size_t size = std::min(W, last - i);
+    for (std::size_t l = 0; l != size; ++l) {
+      Real payoff = std::max(sign * (value[l] - payoff_.strike), 0.0) +
+                    std::max(sign * (mirroredValue[l] - payoff_.strike), 0.0);
+      Real control = (value[l] + mirroredValue[l]) / 2;
+      acc.add(discFactor_ * payoff / 2, discFactor_ * control);
+    }
+  }
+  return acc;
+}
@@ -0,0 +1,80 @@
+#ifndef QF_MCBASKETOPTPRICER_HPP
+#define QF_MCBASKETOPTPRICER_HPP
+
+#include "qf/MCAccumulator.hpp"
+#include "qf/MCSettings.hpp"
+#include "qf/MultiAssetPriceGenerator.hpp"
+#include "qf/OptionType.hpp"
+
+#include <cstddef>
+#include <vector>
+
+using Real = double;
+
+// European option on the weighted sum of several underlyings at expiry
+struct BasketPayoff {
+  std::vector<Real> weights;
+  Real strike;
+  OptionType porc;
+};
+
+// option on the spread S_first - S_second of numAssets underlyings: a basket
+// weighted 1 and -1
+[[nodiscard]] auto spreadPayoff(std::size_t numAssets, std::size_t first,
+                                std::size_t second, Real strike,
+                                OptionType porc) -> BasketPayoff;
+
+// Monte-Carlo pricer of basket and spread options on correlated GBMs, with
+// paths from MultiAssetPriceGenerator. Draws always come from Philox
+// streams; the exact scheme, antithetic paths and a control variate, the
+// discounted basket value whose expectation is the basket at spot, apply as
+// in MCEuroOptPricer.
+class MCBasketOptPricer {
+public:
+  MCBasketOptPricer(std::vector<Real> spots,
+                    const std::vector<Real> &volatilities,
+                    const std::vector<Real> &correlation, Real riskFreeRate,
+                    Real timeToExpiry, BasketPayoff payoff,
+                    std::size_t numTimeSteps, std::size_t numScenarios,
+                    bool runParallel, int initSeed, Real quantity,
+                    MCSettings settings = {});
+
+  [[nodiscard]] auto optionPrice() const -> Real;
+  [[nodiscard]] auto standardError() const -> Real;
+
+  [[nodiscard]] auto operator()() const -> Real;
+  [[nodiscard]] auto time() const -> Real;
+
+private:
+  void calculate_();
+
+  // private helper functions
+  void computePrice_();
+  [[nodiscard]] auto accumulate_(std::size_t first, std::size_t last) const
+      -> MCAccumulator;
+
+  // model inputs
+  MultiAssetPriceGenerator generator_;
+  Real riskFreeRate_;
+  Real timeToExpiry_;
+  BasketPayoff payoff_;
+
+  std::size_t numScenarios_;
+  bool runParallel_;
+  int initSeed_;
+
+  Real quantity_;
+
+  MCSettings settings_;
+
+  // computed values
+  Real discFactor_;
+  Real spotBasket_;
+  Real price_;
+  Real standardError_;
+
+  // runtime comparison using concurrency
+  Real time_;
+};
+
+#endif // QF_MCBASKETOPTPRICER_HPP
@@ -1,184 +1,558 @@
-#include "qf/MCEuroOptPricer.hpp"
-#include "qf/EquityPriceGenerator.hpp"
-
-#include <chrono>
-#include <cmath>
-#include <limits>
-#include <numeric>
-#include <vector>
-
-#ifdef _MSC_VER
-#include <future>
-#else
-#include <boost/asio.hpp>
-#endif
-
-MCEuroOptPricer::MCEuroOptPricer(Real spot, Real strike, Real riskFreeRate,
-                                 Real volatility, Real timeToExpiry,
-                                 OptionType porc, std::size_t numTimeSteps,
-                                 std::size_t numScenarios, bool runParallel,
-                                 int initSeed, Real quantity)
-    : spot_(spot), strike_(strike), riskFreeRate_(riskFreeRate),
-      volatility_(volatility), timeToExpiry_(timeToExpiry), porc_(porc),
-      numTimeSteps_(numTimeSteps), numScenarios_(numScenarios),
-      runParallel_(runParallel), initSeed_(initSeed), quantity_(quantity) {
-  discFactor_ = std::exp(-riskFreeRate_ * timeToExpiry_);
-  price_ = 0.0;
-  time_ = 0.0;
-  calculate_();
-}
-
-auto MCEuroOptPricer::optionPrice() const -> Real { return price_; }
-
-auto MCEuroOptPricer::calcDelta(Real pctShift) const -> Real {
-  if (pctShift != 0) {
-    MCEuroOptPricer u(*this);
-    MCEuroOptPricer d(*this);
-    u.spot_ = spot_ * (1 + pctShift);
-    d.spot_ = spot_ * (1 - pctShift);
-    u.calculate_();
-    d.calculate_();
-    Real delta = (u() - d()) / (2 * pctShift * spot_);
-    return delta;
-  }
-  return std::numeric_limits<Real>::quiet_NaN();
-}
-
-auto MCEuroOptPricer::operator()() const -> Real { return this->optionPrice(); }
-
-auto MCEuroOptPricer::time() const -> Real { return time_; }
-
-void MCEuroOptPricer::calculate_() {
-  auto b = std::chrono::steady_clock::now();
-  computePrice_();
-  auto e = std::chrono::steady_clock::now();
-  time_ = static_cast<Real>(
-      std::chrono::duration_cast<std::chrono::milliseconds>(e - b).count());
-}
-
-// private helper functions
-
-// compute the option price
-void MCEuroOptPricer::computePrice_() {
-  if (runParallel_) {
-#ifdef _MSC_VER
-    computePriceWithAsync_();
-#else
-    computePriceWithPool_();
-#endif
-  } else {
-    computePriceNoParallel_();
-  }
-}
-
-// single-threaded implementation
-void MCEuroOptPricer::computePriceNoParallel_() {
-  EquityPriceGenerator epg(spot_, numTimeSteps_, timeToExpiry_, riskFreeRate_,
-                           volatility_);
-  generateSeeds_();
-
-  std::vector<Real> discountedPayoffs;
-  discountedPayoffs.reserve(numScenarios_);
-
-  for (auto &seed : seeds_) {
-    Real terminalPrice = (epg(seed)).back();
-    Real payoff = payoff_(terminalPrice);
-
-    discountedPayoffs.push_back(discFactor_ * payoff);
-  }
-
-  Real numScens = static_cast<Real>(numScenarios_);
-  price_ =
-      quantity_ * (1.0 / numScens) *
-      std::accumulate(discountedPayoffs.begin(), discountedPayoffs.end(), 0.0);
-}
-
-#ifdef _MSC_VER
-// multithreading with std::async
-// std::async is currently pooled on Windows 10, but NOT on UNIX-like systems
-void MCEuroOptPricer::computePriceWithAsync_() {
-  EquityPriceGenerator epg(spot_, numTimeSteps_, timeToExpiry_, riskFreeRate_,
-                           volatility_);
-  generateSeeds_();
-
-  std::vector<std::future<std::vector<Real>>> futures;
-  futures.reserve(numScenarios_);
-
-  for (auto &seed : seeds_) {
-    futures.push_back(std::async(epg, seed));
-  }
-
-  std::vector<Real> discountedPayoffs;
-  discountedPayoffs.reserve(numScenarios_);
-
-  for (auto &future : futures) {
-    Real terminalPrice = future.get().back();
-    Real payoff = payoff_(terminalPrice);
-    discountedPayoffs.push_back(discFactor_ * payoff);
-  }
-
-  Real numScens = static_cast<Real>(numScenarios_);
-  price_ =
-      quantity_ * (1.0 / numScens) *
-      std::accumulate(discountedPayoffs.begin(), discountedPayoffs.end(), 0.0);
-}
-#else
-// multithreading with boost::asio::thread_pool
-void MCEuroOptPricer::computePriceWithPool_() {
-  EquityPriceGenerator epg(spot_, numTimeSteps_, timeToExpiry_, riskFreeRate_,
-                           volatility_);
-  generateSeeds_();
-
-  std::vector<Real> discountedPayoffs;
-  discountedPayoffs.reserve(numScenarios_);
-  std::mutex mtx;
-
-  boost::asio::thread_pool pool(std::thread::hardware_concurrency());
-  for (auto &seed : seeds_) {
-    boost::asio::post(pool, [&]() {
-      Real terminalPrice = (epg(seed)).back();
-      Real payoff = payoff_(terminalPrice);
-      std::lock_guard lock(mtx);
-      discountedPayoffs.push_back(discFactor_ * payoff);
-    });
-  }
-  pool.join();
-
-  Real numScens = static_cast<Real>(numScenarios_);
-  price_ =
-      quantity_ * (1.0 / numScens) *
-      std::accumulate(discountedPayoffs.begin(), discountedPayoffs.end(), 0.0);
-}
-#endif
-
-void MCEuroOptPricer::generateSeeds_() {
-  seeds_.resize(numScenarios_);
-  std::iota(seeds_.begin(), seeds_.end(), initSeed_);
-}
-
-auto MCEuroOptPricer::payoff_(Real termPrice) -> Real {
-  switch (porc_) {
-  case OptionType::Call:
-    return std::max(termPrice - strike_, 0.0);
-  case OptionType::Put:
-    return std::max(strike_ - termPrice, 0.0);
-  default: // This case should NEVER happen
-    return std::numeric_limits<Real>::quiet_NaN();
-  }
-}
-
-/*
-        Copyright 2019 Daniel Hanson
-
-        Licensed under the Apache License, Version 2.0 (the "License");
-        you may not use this file except in compliance with the License.
-        You may obtain a copy of the License at
-
-                http://www.apache.org/licenses/LICENSE-2.0
-
-        Unless required by applicable law or agreed to in writing, software
-        distributed under the License is distributed on an "AS IS" BASIS,
-        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-        See the License for the specific language governing permissions and
-        limitations under the License.
-*/
+#include "qf/MCEuroOptPricer.hpp"
+#include "qf/BinaryIO.hpp"
+#include "qf/EquityPriceGenerator.hpp"
+#include "qf/ScenarioNormals.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+constexpr std::array<char, 8> shardMagic{'Q', 'F', 'M', 'C', 'E', 'U', 'R',
+                                         'O'};
+constexpr std::uint32_t shardVersion = 2;
+} // namespace
+
+template <typename T>
+BasicMCEuroOptPricer<T>::BasicMCEuroOptPricer(
+    Real spot, Real strike, Real riskFreeRate, Real volatility,
+    Real timeToExpiry, OptionType porc, std::size_t numTimeSteps,
+    std::size_t numScenarios, bool runParallel, int initSeed, Real quantity,
+    MCSettings settings, const PricingControl &control)
+    : spot_(spot), strike_(strike), riskFreeRate_(riskFreeRate),
+      volatility_(volatility), timeToExpiry_(timeToExpiry), porc_(porc),
+      numTimeSteps_(numTimeSteps), numScenarios_(numScenarios),
+      runParallel_(runParallel), initSeed_(initSeed), quantity_(quantity),
+      settings_(settings) {
+  if (settings_.shardIndex >= settings_.numShards) {
+    throw std::invalid_argument("Shard index out of range!");
+  }
+  if (settings_.numShards > 1 && settings_.targetStandardError > 0.0) {
+    throw std::invalid_argument("An adaptive run cannot be sharded!");
+  }
+  discFactor_ = std::exp(-riskFreeRate_ * timeToExpiry_);
+  price_ = 0.0;
+  standardError_ = 0.0;
+  numScenariosRun_ = 0;
+  greeks_ = {};
+  time_ = 0.0;
+  calculate_(control);
+}
+
+template <typename T>
+auto BasicMCEuroOptPricer<T>::optionPrice() const -> Real { return price_; }
+
+template <typename T>
+auto BasicMCEuroOptPricer<T>::standardError() const -> Real {
+  return standardError_;
+}
+
+template <typename T>
+auto BasicMCEuroOptPricer<T>::numScenariosRun() const -> std::size_t {
+  return numScenariosRun_;
+}
+
+template <typename T>
+auto BasicMCEuroOptPricer<T>::calcDelta(Real pctShift) const -> Real {
+  if (pctShift != 0) {
+    BasicMCEuroOptPricer u(*this);
+    BasicMCEuroOptPricer d(*this);
+    u.settings_.checkpointFile.clear();
+    d.settings_.checkpointFile.clear();
+    u.spot_ = spot_ * (1 + pctShift);
+    d.spot_ = spot_ * (1 - pctShift);
+    u.calculate_();
+    d.calculate_();
+    Real delta = (u() - d()) / (2 * pctShift * spot_);
+    return delta;
+  }
+  return std::numeric_limits<Real>::quiet_NaN();
+}
+
+template <typename T>
+auto BasicMCEuroOptPricer<T>::calcGreeks() const -> Greeks {
+  if (settings_.greeks) {
+    return greeks_;
+  }
+  BasicMCEuroOptPricer withGreeks(*this);
+  withGreeks.settings_.greeks = true;
+  withGreeks.settings_.checkpointFile.clear();
+  withGreeks.calculate_();
+  return withGreeks.greeks_;
+}
+
+// Shard file layout, native-endian: magic, version and the size of the path
+// scalar, the constructor arguments, the first block of the shard and its
+// pending block nodes, each as first block, level and sums
+template <typename T>
+void BasicMCEuroOptPricer<T>::writeShard(
+    const std::filesystem::path &file) const {
+  std::ofstream out(file, std::ios::binary);
+  out.write(shardMagic.data(), shardMagic.size());
+  writeBinary(out, shardVersion);
+  writeBinary(out, static_cast<std::uint8_t>(sizeof(T)));
+  for (Real input : {spot_, strike_, riskFreeRate_, volatility_, timeToExpiry_,
+                     quantity_, settings_.targetStandardError}) {
+    writeBinary(out, input);
+  }
+  for (std::size_t count :
+       {numTimeSteps_, numScenarios_, settings_.batchSize, settings_.numShards,
+        settings_.shardIndex}) {
+    writeBinary(out, static_cast<std::uint64_t>(count));
+  }
+  writeBinary(out, static_cast<std::int32_t>(initSeed_));
+  writeBinary(out, porc_);
+  writeBinary(out, settings_.pathScheme);
+  writeBinary(out, settings_.randomEngine);
+  for (bool flag : {runParallel_, settings_.brownianBridge,
+                    settings_.antithetic, settings_.controlVariate,
+                    settings_.greeks}) {
+    writeBinary(out, static_cast<std::uint8_t>(flag));
+  }
+
+  const auto &nodes = reduction_.nodes();
+  const std::size_t firstBlock =
+      nodes.empty() ? reduction_.nextBlock() : nodes.front().firstBlock;
+  writeBinary(out, static_cast<std::uint64_t>(firstBlock));
+  writeBinary(out, static_cast<std::uint64_t>(nodes.size()));
+  for (const auto &node : nodes) {
+    writeBinary(out, static_cast<std::uint64_t>(node.firstBlock));
+    writeBinary(out, static_cast<std::uint64_t>(node.level));
+    node.partial.payoffs.write(out);
+    for (Real sum : {node.partial.delta, node.partial.gamma, node.partial.vega,
+                     node.partial.rho}) {
+      writeBinary(out, sum);
+    }
+  }
+  if (!out) {
+    throw std::runtime_error("Cannot write shard file!");
+  }
+}
+
+// the nodes of the shards, in shard order, go through one reduction from
+// block zero, which rebuilds the merge tree of a single process
+template <typename T>
+auto BasicMCEuroOptPricer<T>::fromShards(
+    const std::vector<std::filesystem::path> &files) -> BasicMCEuroOptPricer {
+  auto b = std::chrono::steady_clock::now();
+  std::vector<BasicMCEuroOptPricer> shards;
+  shards.reserve(files.size());
+  for (const auto &file : files) {
+    std::ifstream in(file, std::ios::binary);
+    shards.push_back(BasicMCEuroOptPricer(in));
+  }
+  if (shards.empty() || shards.size() != shards.front().settings_.numShards) {
+    throw std::invalid_argument("Need one file per shard!");
+  }
+  std::sort(shards.begin(), shards.end(), [](const auto &x, const auto &y) {
+    return x.settings_.shardIndex < y.settings_.shardIndex;
+  });
+
+  BasicMCEuroOptPricer merged(shards.front());
+  merged.settings_.numShards = 1;
+  merged.settings_.shardIndex = 0;
+  merged.reduction_ = BlockReduction<Partial>();
+  for (std::size_t k = 0; k != shards.size(); ++k) {
+    if (shards[k].settings_.shardIndex != k || !shards[k].sameRun_(merged)) {
+      throw std::invalid_argument("Shard files are not of the same run!");
+    }
+    for (const auto &node : shards[k].reduction_.nodes()) {
+      if (node.firstBlock != merged.reduction_.nextBlock()) {
+        throw std::invalid_argument("Shard files leave out scenarios!");
+      }
+      merged.reduction_.push(node.level, node.partial);
+    }
+  }
+  if (merged.reduction_.nextBlock() !=
+      numScenarioBlocks(merged.numScenarios_)) {
+    throw std::invalid_argument("Shard files leave out scenarios!");
+  }
+  merged.setResults_(merged.reduction_.result());
+  merged.numScenariosRun_ = merged.numScenarios_;
+
+  auto e = std::chrono::steady_clock::now();
+  merged.time_ = static_cast<Real>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(e - b).count());
+  return merged;
+}
+
+template <typename T>
+auto BasicMCEuroOptPricer<T>::operator()() const -> Real {
+  return this->optionPrice();
+}
+
+template <typename T>
+auto BasicMCEuroOptPricer<T>::time() const -> Real { return time_; }
+
+template <typename T>
+BasicMCEuroOptPricer<T>::BasicMCEuroOptPricer(std::istream &in) {
+  std::array<char, shardMagic.size()> magic{};
+  in.read(magic.data(), magic.size());
+  std::uint32_t version = 0;
+  std::uint8_t precision = 0;
+  readBinary(in, version);
+  readBinary(in, precision);
+  if (!in || magic != shardMagic || version != shardVersion) {
+    throw std::runtime_error("Cannot read shard file!");
+  }
+  if (precision != sizeof(T)) {
+    throw std::invalid_argument("Shard file is of another precision!");
+  }
+  for (Real *input : {&spot_, &strike_, &riskFreeRate_, &volatility_,
+                      &timeToExpiry_, &quantity_,
+                      &settings_.targetStandardError}) {
+    readBinary(in, *input);
+  }
+  for (std::size_t *count :
+       {&numTimeSteps_, &numScenarios_, &settings_.batchSize,
+        &settings_.numShards, &settings_.shardIndex}) {
+    std::uint64_t value = 0;
+    readBinary(in, value);
+    *count = static_cast<std::size_t>(value);
+  }
+  std::int32_t initSeed = 0;
+  readBinary(in, initSeed);
+  initSeed_ = initSeed;
+  readBinary(in, porc_);
+  readBinary(in, settings_.pathScheme);
+  readBinary(in, settings_.randomEngine);
+  for (bool *flag : {&runParallel_, &settings_.brownianBridge,
+                     &settings_.antithetic, &settings_.controlVariate,
+                     &settings_.greeks}) {
+    std::uint8_t value = 0;
+    readBinary(in, value);
+    *flag = value != 0;
+  }
+
+  std::uint64_t firstBlock = 0;
+  std::uint64_t numNodes = 0;
+  readBinary(in, firstBlock);
+  readBinary(in, numNodes);
+  reduction_ = BlockReduction<Partial>(static_cast<std::size_t>(firstBlock));
+  for (std::uint64_t k = 0; k != numNodes && in; ++k) {
+    std::uint64_t nodeBlock = 0;
+    std::uint64_t level = 0;
+    Partial partial;
+    readBinary(in, nodeBlock);
+    readBinary(in, level);
+    partial.payoffs.read(in);
+    for (Real *sum : {&partial.delta, &partial.gamma, &partial.vega,
+                      &partial.rho}) {
+      readBinary(in, *sum);
+    }
+    if (nodeBlock != reduction_.nextBlock() || level >= 64) {
+      throw std::runtime_error("Corrupt shard file!");
+    }
+    reduction_.push(static_cast<std::size_t>(level), partial);
+  }
+  if (!in) {
+    throw std::runtime_error("Cannot read shard file!");
+  }
+
+  discFactor_ = std::exp(-riskFreeRate_ * timeToExpiry_);
+  price_ = 0.0;
+  standardError_ = 0.0;
+  greeks_ = {};
+  time_ = 0.0;
+  setResults_(reduction_.result());
+  numScenariosRun_ = 0;
+  for (const auto &node : reduction_.nodes()) {
+    numScenariosRun_ += node.partial.payoffs.count();
+  }
+}
+
+template <typename T>
+void BasicMCEuroOptPricer<T>::calculate_(const PricingControl &control) {
+  auto b = std::chrono::steady_clock::now();
+  computePrice_(control);
+  auto e = std::chrono::steady_clock::now();
+  time_ = static_cast<Real>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(e - b).count());
+}
+
+// private helper functions
+
+// Compute the option price. Scenarios are reduced in fixed blocks merged in a
+// fixed order, so the result does not depend on the number of workers; an
+// adaptive run adds one batch of blocks at a time and stops once the standard
+// error is on target or the budget is spent.
+template <typename T>
+void BasicMCEuroOptPricer<T>::computePrice_(const PricingControl &control) {
+  BasicEquityPriceGenerator<T> epg(
+      static_cast<T>(spot_), numTimeSteps_, static_cast<T>(timeToExpiry_),
+      static_cast<T>(riskFreeRate_), static_cast<T>(volatility_));
+  // once stopped, the workers skip their remaining blocks, and the request is
+  // cancelled on this thread when they are done
+  const bool exact = settings_.pathScheme == PathScheme::Exact;
+  auto accumulate = [&, normals = ScenarioNormals(settings_, initSeed_,
+                                                  exact ? 1 : numTimeSteps_)](
+                        std::size_t first, std::size_t last) mutable {
+    return control.stopRequested() ? Partial{}
+                                   : accumulate_(epg, normals, first, last);
+  };
+
+  const bool adaptive = settings_.targetStandardError > 0.0;
+  const std::size_t numBlocks = numScenarioBlocks(numScenarios_);
+  const std::size_t firstBlock =
+      numBlocks * settings_.shardIndex / settings_.numShards;
+  const std::size_t lastBlock =
+      numBlocks * (settings_.shardIndex + 1) / settings_.numShards;
+  const std::size_t batchBlocks = numScenarioBlocks(settings_.batchSize);
+  // a request that can be stopped or is watched goes a batch at a time
+  const std::size_t stepBlocks =
+      adaptive || control.active() ? batchBlocks : numBlocks;
+
+  const bool checkpointing = !settings_.checkpointFile.empty();
+  const std::size_t checkpointBlocks =
+      numScenarioBlocks(settings_.checkpointInterval);
+
+  reduction_ = BlockReduction<Partial>(firstBlock);
+  if (checkpointing && std::filesystem::exists(settings_.checkpointFile)) {
+    resume_();
+  }
+
+  // an adaptive run may only stop at the end of a batch, wherever the
+  // checkpoints fall, so that a resumed run stops where an uninterrupted one
+  // does
+  auto finished = [&]() {
+    const std::size_t done = reduction_.nextBlock() - firstBlock;
+    if (reduction_.nextBlock() >= lastBlock) {
+      return true;
+    }
+    if (!adaptive || done == 0 || done % batchBlocks != 0) {
+      return false;
+    }
+    setResults_(reduction_.result());
+    return standardError_ <= settings_.targetStandardError;
+  };
+  while (!finished()) {
+    const std::size_t next = reduction_.nextBlock();
+    std::size_t end = std::min(
+        lastBlock, next + stepBlocks - (next - firstBlock) % stepBlocks);
+    if (checkpointing) {
+      end = std::min(end, next + checkpointBlocks);
+    }
+    reduceScenarioBlocks(reduction_, end, numScenarios_, runParallel_,
+                         accumulate);
+    control.throwIfStopped();
+    if (checkpointing) {
+      checkpoint_();
+    }
+    if (control.onProgress) {
+      setResults_(reduction_.result());
+      control.report({static_cast<Real>(end - firstBlock) /
+                          static_cast<Real>(lastBlock - firstBlock),
+                      price_, standardError_});
+    }
+  }
+  setResults_(reduction_.result());
+  numScenariosRun_ =
+      std::min(reduction_.nextBlock() * scenarioBlockSize, numScenarios_) -
+      std::min(firstBlock * scenarioBlockSize, numScenarios_);
+}
+
+// discounted payoffs over scenarios [first, last); only terminal prices are
+// generated. With Philox, scenario i is stream i and the prices come from the
+// batched kernel a few hundred at a time; the other engines draw scenario i
+// from normals. Antithetic scenarios rerun the same draws with the
+// opposite sign.
+template <typename T>
+auto BasicMCEuroOptPricer<T>::accumulate_(
+    const BasicEquityPriceGenerator<T> &epg, ScenarioNormals &normals,
+    std::size_t first, std::size_t last) const -> Partial {
+  const bool exact = settings_.pathScheme == PathScheme::Exact;
+  const bool antithetic = settings_.antithetic;
+  Partial acc;
+
+  if (settings_.randomEngine == RandomEngine::Philox) {
+    const auto seed = static_cast<std::uint64_t>(initSeed_);
+    std::array<T, 256> terminalPrices{};
+    std::array<T, 256> mirroredPrices{};
+    for (std::size_t i = first; i < last; i += terminalPrices.size()) {
+      const std::size_t size = std::min(terminalPrices.size(), last - i);
+      std::span<T> batch(terminalPrices.data(), size);
+      std::span<T> mirrored(mirroredPrices.data(), antithetic ? size : 0);
+      if (exact) {
+        epg.exactTerminalPrices(seed, i, batch, mirrored);
+      } else {
+        epg.terminalPrices(seed, i, batch, mirrored);
+      }
+      for (std::size_t j = 0; j != size; ++j) {
+        addScenario_(acc, batch[j], antithetic ? mirrored[j] : batch[j]);
+      }
+    }
+    return acc;
+  }
+
+  // the Mersenne Twister and Sobol points go through the scalar generator
+  std::array<Real, 2> prices{};
+  auto simulate = [&](auto &&normals, bool mirrored) {
+    prices[mirrored ? 1 : 0] =
+        exact ? epg.exactTerminalPrice(normals) : epg.terminalPrice(normals);
+  };
+  auto add = [&]() {
+    addScenario_(acc, prices[0], antithetic ? prices[1] : prices[0]);
+  };
+  normals.forEach(first, last, simulate, add);
+  return acc;
+}
+
+// one sample per scenario: the discounted payoff, averaged with that of the
+// mirrored path (the path itself without antithetic variates), and the
+// discounted terminal price as the control
+template <typename T>
+void BasicMCEuroOptPricer<T>::addScenario_(Partial &acc, Real termPrice,
+                                           Real mirroredTermPrice) const {
+  Real payoff = (payoff_(termPrice) + payoff_(mirroredTermPrice)) / 2;
+  Real control = (termPrice + mirroredTermPrice) / 2;
+  acc.payoffs.add(discFactor_ * payoff, discFactor_ * control);
+  if (settings_.greeks) {
+    addGreeks_(acc, termPrice, 0.5);
+    addGreeks_(acc, mirroredTermPrice, 0.5);
+  }
+}
+
+// Pathwise derivatives of the discounted payoff of one path, weighted. The
+// terminal price S = S0 exp((r - vol^2 / 2) T + vol W) gives the Brownian
+// end point W, so dS/dS0 = S / S0, dS/dvol = S (W - vol T) and dS/dr = S T.
+// Gamma is the likelihood-ratio derivative of the pathwise delta, whose
+// score with respect to S0 is W / (S0 vol T).
+template <typename T>
+void BasicMCEuroOptPricer<T>::addGreeks_(Partial &acc, Real termPrice,
+                                         Real weight) const {
+  // derivative of the payoff in the terminal price
+  Real slope = 0.0;
+  if (porc_ == OptionType::Call && termPrice > strike_) {
+    slope = 1.0;
+  } else if (porc_ == OptionType::Put && termPrice < strike_) {
+    slope = -1.0;
+  }
+  Real w = weight * discFactor_;
+  Real brownian = (std::log(termPrice / spot_) -
+                   (riskFreeRate_ - volatility_ * volatility_ / 2) *
+                       timeToExpiry_) /
+                  volatility_;
+  Real pathDelta = slope * termPrice / spot_;
+
+  acc.delta += w * pathDelta;
+  acc.gamma += w * pathDelta / spot_ *
+               (brownian / (volatility_ * timeToExpiry_) - 1.0);
+  acc.vega += w * slope * termPrice * (brownian - volatility_ * timeToExpiry_);
+  acc.rho += w * timeToExpiry_ * (slope * termPrice - payoff_(termPrice));
+}
+
+// price and standard error of the position from the merged sums
+template <typename T>
+void BasicMCEuroOptPricer<T>::setResults_(const Partial &acc) {
+  const MCAccumulator &payoffs = acc.payoffs;
+  if (settings_.controlVariate) {
+    price_ = quantity_ * payoffs.controlledMean(spot_);
+    standardError_ = std::abs(quantity_) * payoffs.controlledStandardError();
+  } else {
+    price_ = quantity_ * payoffs.mean();
+    standardError_ = std::abs(quantity_) * payoffs.standardError();
+  }
+
+  if (settings_.greeks) {
+    Real scale = quantity_ / static_cast<Real>(payoffs.count());
+    greeks_.price = price_;
+    greeks_.delta = scale * acc.delta;
+    greeks_.gamma = scale * acc.gamma;
+    greeks_.vega = scale * acc.vega;
+    greeks_.rho = scale * acc.rho;
+    // Black-Scholes equation: theta + r S delta + vol^2 S^2 gamma / 2 = r V
+    greeks_.theta = riskFreeRate_ * price_ -
+                    riskFreeRate_ * spot_ * greeks_.delta -
+                    volatility_ * volatility_ * spot_ * spot_ *
+                        greeks_.gamma / 2;
+  }
+}
+
+// The saved state must be that of the same run and shard; how many workers
+// ran it does not matter.
+template <typename T>
+void BasicMCEuroOptPricer<T>::resume_() {
+  std::ifstream in(settings_.checkpointFile, std::ios::binary);
+  BasicMCEuroOptPricer saved(in);
+  if (!sameRun_(saved) || saved.settings_.numShards != settings_.numShards ||
+      saved.settings_.shardIndex != settings_.shardIndex) {
+    throw std::invalid_argument("Checkpoint file is of another run!");
+  }
+  reduction_ = std::move(saved.reduction_);
+}
+
+// written next to the checkpoint and renamed over it, so a run killed while
+// writing still leaves the previous checkpoint intact
+template <typename T>
+void BasicMCEuroOptPricer<T>::checkpoint_() const {
+  std::filesystem::path staging = settings_.checkpointFile;
+  staging += ".tmp";
+  writeShard(staging);
+  std::filesystem::rename(staging, settings_.checkpointFile);
+}
+
+// all the inputs but the shard index agree
+template <typename T>
+auto BasicMCEuroOptPricer<T>::sameRun_(
+    const BasicMCEuroOptPricer &other) const -> bool {
+  MCSettings settings = settings_;
+  settings.shardIndex = other.settings_.shardIndex;
+  settings.numShards = other.settings_.numShards;
+  settings.checkpointFile = other.settings_.checkpointFile;
+  settings.checkpointInterval = other.settings_.checkpointInterval;
+  return spot_ == other.spot_ && strike_ == other.strike_ &&
+         riskFreeRate_ == other.riskFreeRate_ &&
+         volatility_ == other.volatility_ &&
+         timeToExpiry_ == other.timeToExpiry_ && porc_ == other.porc_ &&
+         numTimeSteps_ == other.numTimeSteps_ &&
+         numScenarios_ == other.numScenarios_ && initSeed_ == other.initSeed_ &&
+         quantity_ == other.quantity_ && settings == other.settings_;
+}
+
+template <typename T>
+void BasicMCEuroOptPricer<T>::Partial::merge(const Partial &other) {
+  payoffs.merge(other.payoffs);
+  delta += other.delta;
+  gamma += other.gamma;
+  vega += other.vega;
+  rho += other.rho;
+}
+
+template <typename T>
+auto BasicMCEuroOptPricer<T>::payoff_(Real termPrice) const -> Real {
+  switch (porc_) {
+  case OptionType::Call:
+    return std::max(termPrice - strike_, 0.0);
+  case OptionType::Put:
+    return std::max(strike_ - termPrice, 0.0);
+  default: // This case should NEVER happen
+    return std::numeric_limits<Real>::quiet_NaN();
+  }
+}
+
+template class BasicMCEuroOptPricer<float>;
+template class BasicMCEuroOptPricer<double>;
+
+/*
+        Copyright 2019 Daniel Hanson
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+*/
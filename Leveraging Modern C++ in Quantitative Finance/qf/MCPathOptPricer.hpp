@@ -0,0 +1,144 @@
+#ifndef QF_MCPATHOPTPRICER_HPP
+#define QF_MCPATHOPTPRICER_HPP
+
+#include "qf/BSMOptPricer.hpp"
+#include "qf/BlockReduction.hpp"
+#include "qf/EquityPriceGenerator.hpp"
+#include "qf/MCAccumulator.hpp"
+#include "qf/MCSettings.hpp"
+#include "qf/PathPayoffs.hpp"
+#include "qf/ScenarioNormals.hpp"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+using Real = double;
+
+// Monte-Carlo pricer of a path-dependent option whose payoff is the
+// compile-time policy Payoff, e.g. AsianPayoff<OptionType::Call>. Paths are
+// walked step by step with the dynamics of EquityPriceGenerator and never
+// stored: each price goes straight into the O(1) state of the payoff, and a
+// path stops as soon as the payoff is settled, e.g. by a knock-out. Random
+// engines and antithetic paths are as in MCEuroOptPricer. The control
+// variate is the vanilla European the payoff settles into, whose price is
+// known from BSMOptPricer; knocked-out paths then run on to expiry for it.
+template <PathPayoff Payoff> class MCPathOptPricer {
+public:
+  MCPathOptPricer(Real spot, Real riskFreeRate, Real volatility,
+                  Real timeToExpiry, Payoff payoff, std::size_t numTimeSteps,
+                  std::size_t numScenarios, bool runParallel, int initSeed,
+                  Real quantity, MCSettings settings = {})
+      : spot_(spot), riskFreeRate_(riskFreeRate), volatility_(volatility),
+        timeToExpiry_(timeToExpiry), payoff_(payoff),
+        numTimeSteps_(numTimeSteps), numScenarios_(numScenarios),
+        runParallel_(runParallel), initSeed_(initSeed), quantity_(quantity),
+        settings_(settings) {
+    discFactor_ = std::exp(-riskFreeRate_ * timeToExpiry_);
+    price_ = 0.0;
+    standardError_ = 0.0;
+    time_ = 0.0;
+    calculate_();
+  }
+
+  [[nodiscard]] auto optionPrice() const -> Real { return price_; }
+  [[nodiscard]] auto standardError() const -> Real { return standardError_; }
+
+  [[nodiscard]] auto operator()() const -> Real { return this->optionPrice(); }
+  [[nodiscard]] auto time() const -> Real { return time_; }
+
+private:
+  void calculate_() {
+    auto b = std::chrono::steady_clock::now();
+    computePrice_();
+    auto e = std::chrono::steady_clock::now();
+    time_ = static_cast<Real>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(e - b).count());
+  }
+
+  void computePrice_() {
+    EquityPriceGenerator epg(spot_, numTimeSteps_, timeToExpiry_,
+                             riskFreeRate_, volatility_);
+    MCAccumulator acc = reduceScenarios(
+        numScenarios_, runParallel_,
+        [&, normals = ScenarioNormals(settings_, initSeed_, numTimeSteps_)](
+            std::size_t first, std::size_t last) mutable {
+          return accumulate_(epg, normals, first, last);
+        });
+
+    if (settings_.controlVariate) {
+      BSMOptPricer vanilla(spot_, payoff_.strike, riskFreeRate_, volatility_,
+                           timeToExpiry_, Payoff::optionType, 1.0);
+      price_ = quantity_ * acc.controlledMean(vanilla());
+      standardError_ = std::abs(quantity_) * acc.controlledStandardError();
+    } else {
+      price_ = quantity_ * acc.mean();
+      standardError_ = std::abs(quantity_) * acc.standardError();
+    }
+  }
+
+  // discounted payoffs over scenarios [first, last), averaged over the path
+  // and its mirror image with antithetic variates, with the discounted
+  // vanilla payoff as the control
+  [[nodiscard]] auto accumulate_(const EquityPriceGenerator &epg,
+                                 ScenarioNormals &normals, std::size_t first,
+                                 std::size_t last) const -> MCAccumulator {
+    const bool toExpiry = settings_.controlVariate;
+    MCAccumulator acc;
+    std::array<Real, 2> payoffs{};
+    std::array<Real, 2> terminalPrices{};
+
+    auto simulate = [&](auto &&normals, bool mirrored) {
+      typename Payoff::State state = payoff_.start(spot_);
+      Real terminalPrice = spot_;
+      bool live = true;
+      epg.walk(normals, [&](std::size_t, Real price) {
+        live = live && payoff_.observe(state, price);
+        terminalPrice = price;
+        return live || toExpiry;
+      });
+      payoffs[mirrored ? 1 : 0] = payoff_.value(state);
+      terminalPrices[mirrored ? 1 : 0] = terminalPrice;
+    };
+    auto add = [&]() {
+      const std::size_t m = settings_.antithetic ? 1 : 0;
+      Real payoff = (payoffs[0] + payoffs[m]) / 2;
+      Real control =
+          (vanillaPayoff<Payoff::optionType>(terminalPrices[0],
+                                             payoff_.strike) +
+           vanillaPayoff<Payoff::optionType>(terminalPrices[m],
+                                             payoff_.strike)) /
+          2;
+      acc.add(discFactor_ * payoff, discFactor_ * control);
+    };
+    normals.forEach(first, last, simulate, add);
+    return acc;
+  }
+
+  // model inputs
+  Real spot_;
+  Real riskFreeRate_;
+  Real volatility_;
+  Real timeToExpiry_;
+  Payoff payoff_;
+
+  std::size_t numTimeSteps_;
+  std::size_t numScenarios_;
+  bool runParallel_;
+  int initSeed_;
+
+  Real quantity_;
+
+  MCSettings settings_;
+
+  // computed values
+  Real discFactor_;
+  Real price_;
+  Real standardError_;
+
+  // runtime comparison using concurrency
+  Real time_;
+};
+
+#endif // QF_MCPATHOPTPRICER_HPP
@@ -0,0 +1,184 @@
+#include "qf/MCPortfolioPricer.hpp"
+#include "qf/BlockReduction.hpp"
+#include "qf/EquityPriceGenerator.hpp"
+#include "qf/ScenarioNormals.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+MCPortfolioPricer::MCPortfolioPricer(Real spot, Real riskFreeRate,
+                                     Real volatility, Real timeToExpiry,
+                                     std::size_t numTimeSteps,
+                                     std::size_t numScenarios,
+                                     bool runParallel, int initSeed,
+                                     std::vector<PortfolioOption> options,
+                                     MCSettings settings)
+    : spot_(spot), riskFreeRate_(riskFreeRate), volatility_(volatility),
+      timeToExpiry_(timeToExpiry), numTimeSteps_(numTimeSteps),
+      numScenarios_(numScenarios), runParallel_(runParallel),
+      initSeed_(initSeed), options_(std::move(options)), settings_(settings) {
+  if (options_.empty()) {
+    throw std::invalid_argument("A portfolio needs at least one option!");
+  }
+  for (const auto &option : options_) {
+    if (option.expiryStep == 0 || option.expiryStep > numTimeSteps_) {
+      throw std::invalid_argument("Option expiry outside the time steps!");
+    }
+  }
+
+  byExpiry_.resize(options_.size());
+  std::iota(byExpiry_.begin(), byExpiry_.end(), std::size_t{0});
+  std::stable_sort(byExpiry_.begin(), byExpiry_.end(),
+                   [this](std::size_t a, std::size_t b) {
+                     return options_[a].expiryStep < options_[b].expiryStep;
+                   });
+  const Real dt = timeToExpiry_ / static_cast<Real>(numTimeSteps_);
+  for (std::size_t i = 0; i != byExpiry_.size(); ++i) {
+    std::size_t step = options_[byExpiry_[i]].expiryStep;
+    if (expirySteps_.empty() || expirySteps_.back() != step) {
+      groupStart_.push_back(i);
+      expirySteps_.push_back(step);
+      discFactors_.push_back(
+          std::exp(-riskFreeRate_ * dt * static_cast<Real>(step)));
+    }
+  }
+  groupStart_.push_back(byExpiry_.size());
+
+  prices_.assign(options_.size(), 0.0);
+  standardErrors_.assign(options_.size(), 0.0);
+  portfolioValue_ = 0.0;
+  portfolioStandardError_ = 0.0;
+  time_ = 0.0;
+  calculate_();
+}
+
+auto MCPortfolioPricer::optionPrices() const -> const std::vector<Real> & {
+  return prices_;
+}
+
+auto MCPortfolioPricer::standardErrors() const -> const std::vector<Real> & {
+  return standardErrors_;
+}
+
+auto MCPortfolioPricer::portfolioValue() const -> Real {
+  return portfolioValue_;
+}
+
+auto MCPortfolioPricer::portfolioStandardError() const -> Real {
+  return portfolioStandardError_;
+}
+
+auto MCPortfolioPricer::time() const -> Real { return time_; }
+
+void MCPortfolioPricer::calculate_() {
+  auto b = std::chrono::steady_clock::now();
+  computePrice_();
+  auto e = std::chrono::steady_clock::now();
+  time_ = static_cast<Real>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(e - b).count());
+}
+
+// private helper functions
+
+// compute the option prices, in fixed blocks of scenarios shared among the
+// workers when running in parallel
+void MCPortfolioPricer::computePrice_() {
+  EquityPriceGenerator epg(spot_, numTimeSteps_, timeToExpiry_, riskFreeRate_,
+                           volatility_);
+  setResults_(reduceScenarios(
+      numScenarios_, runParallel_,
+      [&, normals = ScenarioNormals(settings_, initSeed_,
+                                    expirySteps_.back())](
+          std::size_t first, std::size_t last) mutable {
+        return accumulate_(epg, normals, first, last);
+      }));
+}
+
+// Sums over scenarios [first, last). A scenario walks one path up to the
+// last expiry, recording the price at each expiry, with the normals of
+// MCEuroOptPricer's stepwise scheme.
+auto MCPortfolioPricer::accumulate_(const EquityPriceGenerator &epg,
+                                    ScenarioNormals &normals, std::size_t first,
+                                    std::size_t last) const -> Partial {
+  Partial acc{std::vector<MCAccumulator>(options_.size()), {}};
+  std::vector<Real> expiryPrices(expirySteps_.size());
+  std::vector<Real> mirroredPrices(expirySteps_.size());
+
+  auto record = [&](auto &&normals, bool mirrored) {
+    std::vector<Real> &prices = mirrored ? mirroredPrices : expiryPrices;
+    std::size_t g = 0;
+    epg.walk(normals, [&](std::size_t step, Real price) {
+      if (step == expirySteps_[g]) {
+        prices[g++] = price;
+      }
+      return g != prices.size();
+    });
+  };
+  auto add = [&]() {
+    addScenario_(acc, expiryPrices,
+                 settings_.antithetic ? mirroredPrices : expiryPrices);
+  };
+  normals.forEach(first, last, record, add);
+  return acc;
+}
+
+// every option against the prices of one scenario at the expiries: the
+// discounted payoff averaged with that of the mirrored path, and the
+// discounted price of the underlying at expiry as the control
+void MCPortfolioPricer::addScenario_(
+    Partial &acc, const std::vector<Real> &expiryPrices,
+    const std::vector<Real> &mirroredPrices) const {
+  Real portfolioPayoff = 0.0;
+  Real portfolioControl = 0.0;
+  for (std::size_t g = 0; g != expirySteps_.size(); ++g) {
+    const Real price = expiryPrices[g];
+    const Real mirroredPrice = mirroredPrices[g];
+    const Real control = discFactors_[g] * (price + mirroredPrice) / 2;
+    for (std::size_t j = groupStart_[g]; j != groupStart_[g + 1]; ++j) {
+      const std::size_t k = byExpiry_[j];
+      const PortfolioOption &option = options_[k];
+      const Real sign = option.porc == OptionType::Call ? 1.0 : -1.0;
+      Real payoff = std::max(sign * (price - option.strike), 0.0) +
+                    std::max(sign * (mirroredPrice - option.strike), 0.0);
+      Real discPayoff = discFactors_[g] * payoff / 2;
+      acc.options[k].add(discPayoff, control);
+      portfolioPayoff += option.quantity * discPayoff;
+      portfolioControl += option.quantity * control;
+    }
+  }
+  acc.portfolio.add(portfolioPayoff, portfolioControl);
+}
+
+// position values and standard errors from the merged sums; every control
+// has expectation spot_
+void MCPortfolioPricer::setResults_(const Partial &acc) {
+  const bool controlled = settings_.controlVariate;
+  Real totalQuantity = 0.0;
+  for (std::size_t k = 0; k != options_.size(); ++k) {
+    const MCAccumulator &option = acc.options[k];
+    const Real quantity = options_[k].quantity;
+    totalQuantity += quantity;
+    prices_[k] =
+        quantity * (controlled ? option.controlledMean(spot_) : option.mean());
+    standardErrors_[k] = std::abs(quantity) *
+                         (controlled ? option.controlledStandardError()
+                                     : option.standardError());
+  }
+  portfolioValue_ = controlled
+                        ? acc.portfolio.controlledMean(totalQuantity * spot_)
+                        : acc.portfolio.mean();
+  portfolioStandardError_ = controlled
+                                ? acc.portfolio.controlledStandardError()
+                                : acc.portfolio.standardError();
+}
+
+void MCPortfolioPricer::Partial::merge(const Partial &other) {
+  for (std::size_t k = 0; k != options.size(); ++k) {
+    options[k].merge(other.options[k]);
+  }
+  portfolio.merge(other.portfolio);
+}
@@ -0,0 +1,103 @@
+#ifndef QF_MCPORTFOLIOPRICER_HPP
+#define QF_MCPORTFOLIOPRICER_HPP
+
+#include "qf/MCAccumulator.hpp"
+#include "qf/MCSettings.hpp"
+#include "qf/OptionType.hpp"
+
+#include <cstddef>
+#include <vector>
+
+using Real = double;
+
+template <typename T> class BasicEquityPriceGenerator;
+using EquityPriceGenerator = BasicEquityPriceGenerator<Real>;
+class ScenarioNormals;
+
+// A European option of a portfolio; it expires at time step expiryStep,
+// 1 to numTimeSteps, of the common simulation
+struct PortfolioOption {
+  Real strike;
+  OptionType porc;
+  Real quantity;
+  std::size_t expiryStep;
+};
+
+// Monte-Carlo valuation of many European options on one underlying. Each path
+// is simulated once, with the dynamics of EquityPriceGenerator, only up to
+// the last expiry, and every option is evaluated against it before the next
+// path, so the cost is that of one simulation however many options there
+// are. The random engine, antithetic and control-variate settings apply as in
+// MCEuroOptPricer; the stepwise scheme is always used, since its steps are
+// exact in law, and Greeks are not estimated.
+class MCPortfolioPricer {
+public:
+  MCPortfolioPricer(Real spot, Real riskFreeRate, Real volatility,
+                    Real timeToExpiry, std::size_t numTimeSteps,
+                    std::size_t numScenarios, bool runParallel, int initSeed,
+                    std::vector<PortfolioOption> options,
+                    MCSettings settings = {});
+
+  // value of each position, in the order of the options given
+  [[nodiscard]] auto optionPrices() const -> const std::vector<Real> &;
+  [[nodiscard]] auto standardErrors() const -> const std::vector<Real> &;
+
+  // value of the whole portfolio, estimated path by path
+  [[nodiscard]] auto portfolioValue() const -> Real;
+  [[nodiscard]] auto portfolioStandardError() const -> Real;
+
+  [[nodiscard]] auto time() const -> Real;
+
+private:
+  // sums over a block of scenarios
+  struct Partial {
+    std::vector<MCAccumulator> options;
+    MCAccumulator portfolio;
+
+    void merge(const Partial &other);
+  };
+
+  void calculate_();
+
+  // private helper functions
+  void computePrice_();
+  [[nodiscard]] auto accumulate_(const EquityPriceGenerator &epg,
+                                 ScenarioNormals &normals, std::size_t first,
+                                 std::size_t last) const -> Partial;
+  void addScenario_(Partial &acc, const std::vector<Real> &expiryPrices,
+                    const std::vector<Real> &mirroredPrices) const;
+  void setResults_(const Partial &acc);
+
+  // model inputs
+  Real spot_;
+  Real riskFreeRate_;
+  Real volatility_;
+  Real timeToExpiry_;
+
+  std::size_t numTimeSteps_;
+  std::size_t numScenarios_;
+  bool runParallel_;
+  int initSeed_;
+
+  std::vector<PortfolioOption> options_;
+
+  MCSettings settings_;
+
+  // options grouped by expiry: group g holds byExpiry_[groupStart_[g]] to
+  // byExpiry_[groupStart_[g + 1] - 1], all expiring at expirySteps_[g]
+  std::vector<std::size_t> byExpiry_;
+  std::vector<std::size_t> groupStart_;
+  std::vector<std::size_t> expirySteps_;
+  std::vector<Real> discFactors_;
+
+  // computed values
+  std::vector<Real> prices_;
+  std::vector<Real> standardErrors_;
+  Real portfolioValue_;
+  Real portfolioStandardError_;
+
+  // runtime comparison using concurrency
+  Real time_;
+};
+
+#endif // QF_MCPORTFOLIOPRICER_HPP
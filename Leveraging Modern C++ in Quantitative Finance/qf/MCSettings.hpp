@@ -0,0 +1,70 @@
+#ifndef QF_MCSETTINGS_HPP
+#define QF_MCSETTINGS_HPP
+
+#include <cstddef>
+#include <filesystem>
+
+using Real = double;
+
+// How a scenario reaches the terminal price of the underlying
+enum class PathScheme {
+  Stepwise, // numTimeSteps log-normal increments, as in EquityPriceGenerator
+  Exact     // a single log-normal draw over the whole time to expiry
+};
+
+// Where the standard normal draws of a scenario come from
+enum class RandomEngine {
+  Philox,         // counter-based: scenario i is stream i under key initSeed
+  MersenneTwister, // a std::mt19937_64 seeded with initSeed + i per scenario
+  Sobol // quasi-random: scenario i is point i of a Sobol sequence scrambled
+        // under initSeed, one dimension per time step
+};
+
+// Optional model settings of MCEuroOptPricer; the defaults give the plain
+// stepwise Monte-Carlo simulation
+struct MCSettings {
+  PathScheme pathScheme = PathScheme::Stepwise;
+  RandomEngine randomEngine = RandomEngine::Philox;
+
+  // with Sobol points, build each stepwise path by Brownian bridge rather
+  // than step by step, so the first dimensions carry most of the variance
+  bool brownianBridge = true;
+
+  // pair every path with its mirror image, driven by the negated normals,
+  // and average the two payoffs
+  bool antithetic = false;
+
+  // regress the payoff on the discounted terminal price of the underlying,
+  // whose risk-neutral expectation is the spot price
+  bool controlVariate = false;
+
+  // estimate delta, gamma, vega, theta and rho in the pricing pass itself,
+  // for MCEuroOptPricer::calcGreeks()
+  bool greeks = false;
+
+  // Adaptive simulation: when positive, scenarios are run batchSize at a time
+  // (rounded up to whole blocks of the reduction) and the simulation stops as
+  // soon as the standard error of the position is at most
+  // targetStandardError, so numScenarios becomes a budget rather than a
+  // count. Zero runs all numScenarios.
+  Real targetStandardError = 0.0;
+  std::size_t batchSize = 16384;
+
+  // Sharded simulation: run only shard shardIndex of numShards, a disjoint
+  // range of whole blocks of scenarios, so that separate processes can share
+  // a run and merge their partial results (see MCEuroOptPricer::writeShard)
+  std::size_t numShards = 1;
+  std::size_t shardIndex = 0;
+
+  // Checkpointing: when a file is named, the state of the run is saved to it
+  // (as a shard file) after every checkpointInterval scenarios, rounded up to
+  // whole blocks, and a run that finds the file resumes from it, to the same
+  // result as an uninterrupted run. A finished run leaves its final state.
+  std::filesystem::path checkpointFile{};
+  std::size_t checkpointInterval = std::size_t{1} << 24;
+
+  friend auto operator==(const MCSettings &, const MCSettings &)
+      -> bool = default;
+};
+
+#endif // QF_MCSETTINGS_HPP
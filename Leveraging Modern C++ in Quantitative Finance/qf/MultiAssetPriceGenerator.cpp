@@ -0,0 +1,87 @@
+#include "qf/MultiAssetPriceGenerator.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+MultiAssetPriceGenerator::MultiAssetPriceGenerator(
+    std::vector<Real> initPrices, std::size_t numTimeSteps, Real timeToExpiry,
+    Real drift, const std::vector<Real> &volatilities,
+    const std::vector<Real> &correlation)
+    : initPrices_(std::move(initPrices)), numTimeSteps_(numTimeSteps) {
+  const std::size_t n = initPrices_.size();
+  if (n == 0 || volatilities.size() != n || correlation.size() != n * n) {
+    throw std::invalid_argument("Asset data of mismatched sizes!");
+  }
+  if (numTimeSteps_ == 0) {
+    throw std::invalid_argument("A simulation needs a time step!");
+  }
+
+  // Cholesky-Banachiewicz, row by row
+  cholesky_.assign(n * n, 0.0);
+  for (std::size_t i = 0; i != n; ++i) {
+    for (std::size_t j = 0; j <= i; ++j) {
+      Real sum = correlation[i * n + j];
+      for (std::size_t k = 0; k != j; ++k) {
+        sum -= cholesky_[i * n + k] * cholesky_[j * n + k];
+      }
+      if (i == j) {
+        if (!(sum > 0.0)) {
+          throw std::invalid_argument(
+              "Correlation matrix is not positive definite!");
+        }
+        cholesky_[i * n + i] = std::sqrt(sum);
+      } else {
+        cholesky_[i * n + j] = sum / cholesky_[j * n + j];
+      }
+    }
+  }
+
+  const Real dt = timeToExpiry / static_cast<Real>(numTimeSteps_);
+  driftTerms_.resize(n);
+  diffusionTerms_.resize(n);
+  for (std::size_t i = 0; i != n; ++i) {
+    const Real vol = volatilities[i];
+    driftTerms_[i] = (drift - vol * vol / 2) * dt;
+    diffusionTerms_[i] = vol * std::sqrt(dt);
+  }
+}
+
+auto MultiAssetPriceGenerator::numAssets() const -> std::size_t {
+  return initPrices_.size();
+}
+
+auto MultiAssetPriceGenerator::numTimeSteps() const -> std::size_t {
+  return numTimeSteps_;
+}
+
+auto MultiAssetPriceGenerator::cholesky() const -> const std::vector<Real> & {
+  return cholesky_;
+}
+
+void MultiAssetPriceGenerator::paths(std::uint64_t seed,
+                                     std::uint64_t firstPath,
+                                     std::span<Real> out,
+                                     std::span<Real> mirroredOut) const {
+  const std::size_t size = (numTimeSteps_ + 1) * numAssets() * blockWidth;
+  if (out.size() != size ||
+      (!mirroredOut.empty() && mirroredOut.size() != size)) {
+    throw std::invalid_argument("Path block of the wrong size!");
+  }
+  gbmCorrelatedPaths(params_(), seed, firstPath, out, mirroredOut);
+}
+
+void MultiAssetPriceGenerator::terminalPrices(
+    std::uint64_t seed, std::uint64_t firstPath, std::span<Real> out,
+    std::span<Real> mirroredOut) const {
+  const std::size_t size = numAssets() * blockWidth;
+  if (out.size() != size ||
+      (!mirroredOut.empty() && mirroredOut.size() != size)) {
+    throw std::invalid_argument("Price block of the wrong size!");
+  }
+  gbmCorrelatedTerminalPrices(params_(), seed, firstPath, out, mirroredOut);
+}
+
+auto MultiAssetPriceGenerator::params_() const -> CorrelatedGBMParams {
+  return {initPrices_, driftTerms_, diffusionTerms_, cholesky_, numTimeSteps_};
+}
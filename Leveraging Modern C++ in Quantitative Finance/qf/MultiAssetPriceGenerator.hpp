@@ -0,0 +1,56 @@
+#ifndef QF_MULTIASSETPRICEGENERATOR_HPP
+#define QF_MULTIASSETPRICEGENERATOR_HPP
+
+#include "qf/GBMKernel.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+using Real = double;
+
+// Correlated GBM paths of several underlyings, the multi-asset counterpart of
+// EquityPriceGenerator. The correlation matrix, numAssets x numAssets and
+// row-major, is factored once at construction; paths then come from the
+// batched kernel of GBMKernel.hpp, blockWidth paths at a time, path p
+// drawing from Philox stream p under the key seed.
+class MultiAssetPriceGenerator {
+public:
+  static constexpr std::size_t blockWidth = gbmBatchWidth;
+
+  MultiAssetPriceGenerator(std::vector<Real> initPrices,
+                           std::size_t numTimeSteps, Real timeToExpiry,
+                           Real drift, const std::vector<Real> &volatilities,
+                           const std::vector<Real> &correlation);
+
+  [[nodiscard]] auto numAssets() const -> std::size_t;
+  [[nodiscard]] auto numTimeSteps() const -> std::size_t;
+
+  // lower-triangular Cholesky factor of the correlation matrix, row-major
+  [[nodiscard]] auto cholesky() const -> const std::vector<Real> &;
+
+  // paths firstPath to firstPath + blockWidth - 1, laid out
+  // [step][asset][path] with numTimeSteps + 1 steps starting at the initial
+  // prices; a non-empty mirroredOut receives the antithetic paths
+  void paths(std::uint64_t seed, std::uint64_t firstPath, std::span<Real> out,
+             std::span<Real> mirroredOut = {}) const;
+
+  // their prices after the last step only, laid out [asset][path]
+  void terminalPrices(std::uint64_t seed, std::uint64_t firstPath,
+                      std::span<Real> out,
+                      std::span<Real> mirroredOut = {}) const;
+
+private:
+  [[nodiscard]] auto params_() const -> CorrelatedGBMParams;
+
+  std::vector<Real> initPrices_;
+  std::size_t numTimeSteps_;
+  std::vector<Real> cholesky_;
+
+  // exponent of one step of asset i is driftTerms_[i] + diffusionTerms_[i] * w
+  std::vector<Real> driftTerms_;
+  std::vector<Real> diffusionTerms_;
+};
+
+#endif // QF_MULTIASSETPRICEGENERATOR_HPP
@@ -0,0 +1,77 @@
+#ifndef QF_NEWTON_HPP
+#define QF_NEWTON_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <type_traits>
+
+namespace qf::root_finder {
+
+using Real = double;
+
+// Newton's method kept inside the bracket [a, b], after rtsafe in Numerical
+// Recipes, 3rd ed., Press et al. 2007. f returns the value and the derivative
+// at x together, as a std::pair, so that a function sharing work between the
+// two is evaluated once per iteration; a step that would leave the bracket,
+// or a zero derivative, falls back to bisection, and the bracket shrinks to
+// the iterate with each evaluation. T is deduced from a alone, and is Real
+// when a is an integer.
+template <typename Func, typename A,
+          std::floating_point T =
+              std::conditional_t<std::floating_point<A>, A, Real>>
+  requires std::convertible_to<A, T>
+auto newton(Func f, A first, std::type_identity_t<T> b,
+            std::type_identity_t<T> initialGuess,
+            std::type_identity_t<T> tolerance =
+                std::sqrt(std::numeric_limits<T>::epsilon()),
+            const unsigned int maxIterations = 100) {
+
+  const T a = first;
+  const T fa = f(a).first;
+  const T fb = f(b).first;
+  if (fa == 0) {
+    return a;
+  }
+  if (fb == 0) {
+    return b;
+  }
+  if (fa * fb > 0) {
+    // Error condition; must have f(b) * f(a) < 0;
+    // otherwise, does not converge:
+    return std::numeric_limits<T>::infinity();
+  }
+
+  // orient the bracket so that f(lo) < 0 < f(hi)
+  T lo = fa < 0 ? a : b;
+  T hi = fa < 0 ? b : a;
+  T x = initialGuess;
+  if (!(x > std::min(a, b) && x < std::max(a, b))) {
+    x = (a + b) / 2;
+  }
+
+  for (unsigned int i = 0; i < maxIterations; ++i) {
+    const auto [fx, dfx] = f(x);
+    if (fx < 0) {
+      lo = x;
+    } else {
+      hi = x;
+    }
+    T next = x - fx / dfx;
+    // also catches the NaN of a zero derivative
+    if (!(next > std::min(lo, hi) && next < std::max(lo, hi))) {
+      next = (lo + hi) / 2;
+    }
+    if (std::abs(next - x) < tolerance) {
+      return next;
+    }
+    x = next;
+  }
+
+  // Error condition: does not converge:
+  return std::numeric_limits<T>::infinity();
+}
+} // namespace qf::root_finder
+
+#endif // QF_NEWTON_HPP
@@ -0,0 +1,125 @@
+#ifndef QF_PATHPAYOFFS_HPP
+#define QF_PATHPAYOFFS_HPP
+
+#include "qf/OptionType.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <utility>
+
+using Real = double;
+
+// Payoff of a path-dependent option, fed the path one price at a time while
+// it is generated, so only a constant-size State is kept per scenario:
+//   start(spot)          state before the first step
+//   observe(state, S)    takes the price after a step; false once the payoff
+//                        can no longer change, e.g. after a knock-out
+//   value(state)         payoff at expiry
+// Every payoff settles into a vanilla European of optionType and strike,
+// which MCPathOptPricer can use as a control variate.
+template <typename P>
+concept PathPayoff =
+    requires(const P &payoff, typename P::State &state, Real price) {
+      { payoff.start(price) } -> std::same_as<typename P::State>;
+      { payoff.observe(state, price) } -> std::same_as<bool>;
+      { payoff.value(std::as_const(state)) } -> std::same_as<Real>;
+      { payoff.strike } -> std::convertible_to<Real>;
+      { P::optionType } -> std::convertible_to<OptionType>;
+    };
+
+template <OptionType Type>
+[[nodiscard]] constexpr auto vanillaPayoff(Real underlying, Real strike)
+    -> Real {
+  if constexpr (Type == OptionType::Call) {
+    return std::max(underlying - strike, 0.0);
+  } else {
+    return std::max(strike - underlying, 0.0);
+  }
+}
+
+// fixed-strike option on the arithmetic average of the prices after each
+// step
+template <OptionType Type> struct AsianPayoff {
+  static constexpr OptionType optionType = Type;
+  Real strike;
+
+  struct State {
+    Real sum;
+    std::size_t count;
+  };
+
+  [[nodiscard]] auto start(Real /*spot*/) const -> State { return {0.0, 0}; }
+  [[nodiscard]] auto observe(State &state, Real price) const -> bool {
+    state.sum += price;
+    ++state.count;
+    return true;
+  }
+  [[nodiscard]] auto value(const State &state) const -> Real {
+    return vanillaPayoff<Type>(state.sum / static_cast<Real>(state.count),
+                               strike);
+  }
+};
+
+// fixed-strike option on the highest (call) or lowest (put) price of the
+// path, the spot included
+template <OptionType Type> struct LookbackPayoff {
+  static constexpr OptionType optionType = Type;
+  Real strike;
+
+  struct State {
+    Real extremum;
+  };
+
+  [[nodiscard]] auto start(Real spot) const -> State { return {spot}; }
+  [[nodiscard]] auto observe(State &state, Real price) const -> bool {
+    if constexpr (Type == OptionType::Call) {
+      state.extremum = std::max(state.extremum, price);
+    } else {
+      state.extremum = std::min(state.extremum, price);
+    }
+    return true;
+  }
+  [[nodiscard]] auto value(const State &state) const -> Real {
+    return vanillaPayoff<Type>(state.extremum, strike);
+  }
+};
+
+enum class BarrierType { UpAndOut, DownAndOut, UpAndIn, DownAndIn };
+
+// European option that is cancelled (out) or activated (in) once a price of
+// the path, the spot included, reaches the barrier; no rebate is paid. A
+// knocked-out path is settled at zero, so its simulation stops there.
+template <OptionType Type, BarrierType Kind> struct BarrierPayoff {
+  static constexpr OptionType optionType = Type;
+  static constexpr bool up =
+      Kind == BarrierType::UpAndOut || Kind == BarrierType::UpAndIn;
+  static constexpr bool out =
+      Kind == BarrierType::UpAndOut || Kind == BarrierType::DownAndOut;
+  Real strike;
+  Real barrier;
+
+  struct State {
+    Real price;
+    bool hit;
+  };
+
+  [[nodiscard]] auto start(Real spot) const -> State {
+    return {spot, crosses_(spot)};
+  }
+  [[nodiscard]] auto observe(State &state, Real price) const -> bool {
+    state.price = price;
+    state.hit = state.hit || crosses_(price);
+    return !(out && state.hit);
+  }
+  [[nodiscard]] auto value(const State &state) const -> Real {
+    return state.hit == out ? 0.0 : vanillaPayoff<Type>(state.price, strike);
+  }
+
+private:
+  [[nodiscard]] auto crosses_(Real price) const -> bool {
+    return up ? price >= barrier : price <= barrier;
+  }
+};
+
+#endif // QF_PATHPAYOFFS_HPP
@@ -0,0 +1,89 @@
+#ifndef QF_PHILOX_HPP
+#define QF_PHILOX_HPP
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+
+using Real = double;
+
+// Philox4x32-10 counter-based generator (Salmon, Moraes, Dror and Shaw,
+// "Parallel Random Numbers: As Easy as 1, 2, 3", SC 2011).
+// Random block n of stream s under key k is block({n, s}, k): any scenario
+// can be addressed directly, with no state to seed or to skip through.
+class Philox4x32 {
+public:
+  using Counter = std::array<std::uint32_t, 4>;
+  using Key = std::array<std::uint32_t, 2>;
+
+  [[nodiscard]] static constexpr auto block(Counter ctr, Key key) -> Counter {
+    for (int round = 0; round != 10; ++round) {
+      std::uint64_t p0 = std::uint64_t{0xD2511F53} * ctr[0];
+      std::uint64_t p1 = std::uint64_t{0xCD9E8D57} * ctr[2];
+      ctr = {static_cast<std::uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0],
+             static_cast<std::uint32_t>(p1),
+             static_cast<std::uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1],
+             static_cast<std::uint32_t>(p0)};
+      key[0] += 0x9E3779B9;
+      key[1] += 0xBB67AE85;
+    }
+    return ctr;
+  }
+
+  // counter of block n in stream s
+  [[nodiscard]] static constexpr auto counter(std::uint64_t n, std::uint64_t s)
+      -> Counter {
+    return {static_cast<std::uint32_t>(n), static_cast<std::uint32_t>(n >> 32),
+            static_cast<std::uint32_t>(s), static_cast<std::uint32_t>(s >> 32)};
+  }
+
+  [[nodiscard]] static constexpr auto key(std::uint64_t seed) -> Key {
+    return {static_cast<std::uint32_t>(seed),
+            static_cast<std::uint32_t>(seed >> 32)};
+  }
+};
+
+// Standard normal draws of one Philox stream, two per block by Box-Muller.
+// Constructing it costs nothing, so one can be made per scenario.
+class PhiloxNormalGenerator {
+public:
+  PhiloxNormalGenerator(std::uint64_t seed, std::uint64_t stream)
+      : key_(Philox4x32::key(seed)), stream_(stream) {}
+
+  auto operator()() -> Real {
+    if (hasSpare_) {
+      hasSpare_ = false;
+      return spare_;
+    }
+    Philox4x32::Counter r =
+        Philox4x32::block(Philox4x32::counter(block_++, stream_), key_);
+    // 52-bit uniforms, u1 in (0, 1] so that its log is finite
+    Real u1 = 1.0 - toUnit_(r[0], r[1]);
+    Real u2 = toUnit_(r[2], r[3]);
+    Real radius = std::sqrt(-2.0 * std::log(u1));
+    Real angle = 2.0 * std::numbers::pi * u2;
+    spare_ = radius * std::sin(angle);
+    hasSpare_ = true;
+    return radius * std::cos(angle);
+  }
+
+private:
+  // the top 52 bits as the mantissa of a double in [1, 2), minus one; the
+  // batched kernel in GBMKernel.cpp builds its uniforms the same way
+  [[nodiscard]] static auto toUnit_(std::uint32_t lo, std::uint32_t hi)
+      -> Real {
+    std::uint64_t bits = (std::uint64_t{hi} << 32) | lo;
+    return std::bit_cast<Real>((bits >> 12) | 0x3FF0000000000000) - 1.0;
+  }
+
+  Philox4x32::Key key_;
+  std::uint64_t stream_;
+  std::uint64_t block_ = 0;
+  Real spare_ = 0.0;
+  bool hasSpare_ = false;
+};
+
+#endif // QF_PHILOX_HPP
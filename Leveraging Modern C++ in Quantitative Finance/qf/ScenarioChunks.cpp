@@ -0,0 +1,55 @@
+#include "qf/ScenarioChunks.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <future>
+#else
+#include <boost/asio.hpp>
+#endif
+
+auto numScenarioChunks(std::size_t numScenarios) -> std::size_t {
+  std::size_t numThreads = std::max(std::thread::hardware_concurrency(), 1U);
+  return std::max(std::min(numThreads, numScenarios), std::size_t{1});
+}
+
+auto scenarioChunk(std::size_t numScenarios, std::size_t k,
+                   std::size_t numChunks)
+    -> std::pair<std::size_t, std::size_t> {
+  return {numScenarios * k / numChunks, numScenarios * (k + 1) / numChunks};
+}
+
+// std::async is pooled on Windows, but NOT on UNIX-like systems, where a
+// boost::asio::thread_pool is used instead
+void runScenarioChunks(
+    std::size_t numScenarios, std::size_t numChunks,
+    const std::function<void(std::size_t, std::size_t, std::size_t)> &task) {
+  auto run = [&](std::size_t k) {
+    auto [first, last] = scenarioChunk(numScenarios, k, numChunks);
+    task(k, first, last);
+  };
+  if (numChunks == 1) {
+    run(0);
+    return;
+  }
+#ifdef _MSC_VER
+  std::vector<std::future<void>> futures;
+  futures.reserve(numChunks - 1);
+  for (std::size_t k = 1; k != numChunks; ++k) {
+    futures.push_back(std::async(std::launch::async, run, k));
+  }
+  run(0);
+  for (auto &future : futures) {
+    future.get();
+  }
+#else
+  boost::asio::thread_pool pool(numChunks - 1);
+  for (std::size_t k = 1; k != numChunks; ++k) {
+    boost::asio::post(pool, [&run, k]() { run(k); });
+  }
+  run(0);
+  pool.join();
+#endif
+}
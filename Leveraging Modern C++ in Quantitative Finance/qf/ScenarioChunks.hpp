@@ -0,0 +1,24 @@
+#ifndef QF_SCENARIOCHUNKS_HPP
+#define QF_SCENARIOCHUNKS_HPP
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+// one chunk per hardware thread, but never more chunks than scenarios
+[[nodiscard]] auto numScenarioChunks(std::size_t numScenarios) -> std::size_t;
+
+// scenario range [first, last) of the k-th of numChunks chunks
+[[nodiscard]] auto scenarioChunk(std::size_t numScenarios, std::size_t k,
+                                 std::size_t numChunks)
+    -> std::pair<std::size_t, std::size_t>;
+
+// Runs task(k, first, last) for each of numChunks chunks of the scenarios,
+// one worker per chunk, all at once, and returns once all are done; chunk 0
+// runs on the calling thread. Workers share nothing, so each task writes its
+// own result and no lock is taken.
+void runScenarioChunks(
+    std::size_t numScenarios, std::size_t numChunks,
+    const std::function<void(std::size_t, std::size_t, std::size_t)> &task);
+
+#endif // QF_SCENARIOCHUNKS_HPP
@@ -0,0 +1,121 @@
+#ifndef QF_SCENARIONORMALS_HPP
+#define QF_SCENARIONORMALS_HPP
+
+#include "qf/BrownianBridge.hpp"
+#include "qf/MCSettings.hpp"
+#include "qf/Philox.hpp"
+#include "qf/Sobol.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+using Real = double;
+
+// The standard normals of the scenarios of a simulation. Scenario i draws
+// from Philox stream i under key initSeed, from a std::mt19937_64 seeded with
+// initSeed + i, or from point i of the scrambled Sobol sequence, through the
+// Brownian bridge if asked, as settings.randomEngine chooses; dimension is
+// the number of normals a path may take. The Sobol sequence and the bridge
+// are built once, with the object, and a copy is meant for each worker, which
+// only seeks the sequence to each of its blocks.
+class ScenarioNormals {
+public:
+  ScenarioNormals(const MCSettings &settings, int initSeed,
+                  std::size_t dimension)
+      : randomEngine_(settings.randomEngine),
+        antithetic_(settings.antithetic), initSeed_(initSeed) {
+    if (randomEngine_ == RandomEngine::Sobol) {
+      sobol_.emplace(dimension, static_cast<std::uint64_t>(initSeed));
+      if (settings.brownianBridge && dimension > 1) {
+        bridge_.emplace(dimension);
+      }
+      point_.resize(dimension);
+      normals_.resize(dimension);
+    }
+  }
+
+  // Feeds the normals of scenarios [first, last) to simulate(normals,
+  // mirrored), once per path, and calls finish() after each scenario. With
+  // settings.antithetic a second path, with mirrored set, gets the same
+  // normals negated. The engine is chosen once, outside the loop, so the
+  // draws themselves are not dispatched.
+  template <typename Simulate, typename Finish>
+  void forEach(std::size_t first, std::size_t last, Simulate &&simulate,
+               Finish &&finish);
+
+private:
+  RandomEngine randomEngine_;
+  bool antithetic_;
+  int initSeed_;
+  std::optional<SobolSequence> sobol_;
+  std::optional<BrownianBridge> bridge_;
+  std::vector<Real> point_;
+  std::vector<Real> normals_;
+};
+
+template <typename Simulate, typename Finish>
+void ScenarioNormals::forEach(std::size_t first, std::size_t last,
+                              Simulate &&simulate, Finish &&finish) {
+  if (first == last) {
+    return;
+  }
+  const bool antithetic = antithetic_;
+
+  switch (randomEngine_) {
+  case RandomEngine::Philox: {
+    const auto seed = static_cast<std::uint64_t>(initSeed_);
+    for (std::size_t i = first; i != last; ++i) {
+      PhiloxNormalGenerator normals(seed, i);
+      simulate(normals, false);
+      if (antithetic) {
+        PhiloxNormalGenerator mirroredNormals(seed, i);
+        simulate([&]() { return -mirroredNormals(); }, true);
+      }
+      finish();
+    }
+    break;
+  }
+  case RandomEngine::MersenneTwister:
+    for (std::size_t i = first; i != last; ++i) {
+      // two engines in the same state give the same normals to both paths
+      int seed = initSeed_ + static_cast<int>(i);
+      std::mt19937_64 engine(seed);
+      std::normal_distribution<Real> nd;
+      simulate([&]() { return nd(engine); }, false);
+      if (antithetic) {
+        std::mt19937_64 mirroredEngine(seed);
+        std::normal_distribution<Real> mirroredNd;
+        simulate([&]() { return -mirroredNd(mirroredEngine); }, true);
+      }
+      finish();
+    }
+    break;
+  case RandomEngine::Sobol: {
+    sobol_->seek(first);
+    for (std::size_t i = first; i != last; ++i) {
+      sobol_->next(point_);
+      std::transform(point_.begin(), point_.end(), point_.begin(),
+                     inverseNormalCdf);
+      if (bridge_) {
+        bridge_->transform(point_, normals_);
+      } else {
+        normals_.swap(point_);
+      }
+      auto z = normals_.cbegin();
+      simulate([&]() { return *z++; }, false);
+      if (antithetic) {
+        auto mirroredZ = normals_.cbegin();
+        simulate([&]() { return -*mirroredZ++; }, true);
+      }
+      finish();
+    }
+    break;
+  }
+  }
+}
+
+#endif // QF_SCENARIONORMALS_HPP
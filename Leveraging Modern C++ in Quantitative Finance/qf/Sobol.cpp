@@ -0,0 +1,219 @@
+#include "qf/Sobol.hpp"
+#include "qf/Philox.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <stdexcept>
+
+namespace {
+
+// a * b modulo the GF(2) polynomial poly of degree deg, bit i holding the
+// coefficient of x^i
+auto mulMod(std::uint64_t a, std::uint64_t b, std::uint64_t poly, int deg)
+    -> std::uint64_t {
+  std::uint64_t r = 0;
+  for (; b != 0; b >>= 1) {
+    if (b & 1) {
+      r ^= a;
+    }
+    a <<= 1;
+    if ((a >> deg) & 1) {
+      a ^= poly;
+    }
+  }
+  return r;
+}
+
+auto powX(std::uint64_t e, std::uint64_t poly, int deg) -> std::uint64_t {
+  std::uint64_t r = 1;
+  std::uint64_t x = deg == 1 ? (2 ^ poly) : 2; // x mod poly
+  for (; e != 0; e >>= 1) {
+    if (e & 1) {
+      r = mulMod(r, x, poly, deg);
+    }
+    x = mulMod(x, x, poly, deg);
+  }
+  return r;
+}
+
+// poly is primitive iff x has multiplicative order 2^deg - 1 modulo poly
+auto isPrimitive(std::uint64_t poly, int deg) -> bool {
+  const std::uint64_t order = (std::uint64_t{1} << deg) - 1;
+  if (powX(order, poly, deg) != 1) {
+    return false;
+  }
+  std::uint64_t rest = order;
+  for (std::uint64_t q = 3; q * q <= rest; q += 2) {
+    if (rest % q == 0) {
+      if (powX(order / q, poly, deg) == 1) {
+        return false;
+      }
+      while (rest % q == 0) {
+        rest /= q;
+      }
+    }
+  }
+  // whatever is left is the one prime factor above the square root
+  return rest == 1 || powX(order / rest, poly, deg) != 1;
+}
+
+auto reverseBits(std::uint32_t x) -> std::uint32_t {
+  x = ((x >> 1) & 0x55555555U) | ((x & 0x55555555U) << 1);
+  x = ((x >> 2) & 0x33333333U) | ((x & 0x33333333U) << 2);
+  x = ((x >> 4) & 0x0F0F0F0FU) | ((x & 0x0F0F0F0FU) << 4);
+  x = ((x >> 8) & 0x00FF00FFU) | ((x & 0x00FF00FFU) << 8);
+  return (x >> 16) | (x << 16);
+}
+
+// Every step only lets a bit of x affect bits above it, so in bit-reversed
+// order this is a random permutation of each elementary interval: an Owen
+// scramble (Laine and Karras hash with Burley's constants)
+auto nestedUniformScramble(std::uint32_t x, std::uint32_t seed)
+    -> std::uint32_t {
+  x = reverseBits(x);
+  x += seed;
+  x ^= x * 0x6C50B47CU;
+  x ^= x * 0xB82F1E52U;
+  x ^= x * 0xC7AFE638U;
+  x ^= x * 0x8D22F6E6U;
+  return reverseBits(x);
+}
+
+} // namespace
+
+SobolSequence::SobolSequence(std::size_t dimension, std::uint64_t scrambleSeed)
+    : dimension_(dimension), directions_(dimension * numBits_),
+      scrambleSeeds_(dimension), state_(dimension), index_(0) {
+  if (dimension_ == 0) {
+    throw std::invalid_argument("A Sobol sequence needs a dimension!");
+  }
+
+  // the first dimension is the van der Corput sequence in base 2
+  for (std::size_t k = 0; k != numBits_; ++k) {
+    directions_[k] = std::uint32_t{1} << (numBits_ - 1 - k);
+  }
+
+  // initial direction numbers m_1, ..., m_deg are odd with m_k < 2^k
+  const auto initKey = Philox4x32::key(0x536F626F6CULL);
+  std::vector<std::uint32_t> m(numBits_);
+  std::size_t j = 1;
+  for (int deg = 1; j != dimension_; ++deg) {
+    if (deg > 31) {
+      throw std::invalid_argument("Too many Sobol dimensions!");
+    }
+    const std::uint64_t first = (std::uint64_t{1} << deg) | 1;
+    const std::uint64_t last = std::uint64_t{1} << (deg + 1);
+    for (std::uint64_t poly = first; poly < last && j != dimension_;
+         poly += 2) {
+      if (!isPrimitive(poly, deg)) {
+        continue;
+      }
+      const auto s = static_cast<std::size_t>(deg);
+      for (std::size_t k = 0; k != std::min(s, numBits_); ++k) {
+        auto bits = Philox4x32::block(Philox4x32::counter(k, j), initKey)[0];
+        m[k] = (bits & ((std::uint32_t{1} << (k + 1)) - 1)) | 1;
+      }
+      // m_k = 2 a_1 m_{k-1} ^ 4 a_2 m_{k-2} ^ ... ^ 2^s m_{k-s} ^ m_{k-s},
+      // with poly = x^s + a_1 x^{s-1} + ... + a_{s-1} x + 1
+      for (std::size_t k = s; k < numBits_; ++k) {
+        std::uint32_t mk = m[k - s] ^ (m[k - s] << s);
+        for (std::size_t i = 1; i != s; ++i) {
+          if ((poly >> (s - i)) & 1) {
+            mk ^= m[k - i] << i;
+          }
+        }
+        m[k] = mk;
+      }
+      for (std::size_t k = 0; k != numBits_; ++k) {
+        directions_[j * numBits_ + k] = m[k] << (numBits_ - 1 - k);
+      }
+      ++j;
+    }
+  }
+
+  const auto scrambleKey = Philox4x32::key(scrambleSeed);
+  for (std::size_t d = 0; d != dimension_; ++d) {
+    scrambleSeeds_[d] =
+        Philox4x32::block(Philox4x32::counter(d, 0), scrambleKey)[0];
+  }
+}
+
+auto SobolSequence::dimension() const -> std::size_t { return dimension_; }
+
+// point n is the XOR of the direction numbers of the bits set in the Gray
+// code n ^ (n >> 1)
+void SobolSequence::seek(std::uint64_t index) {
+  if (index > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::invalid_argument("Sobol index beyond 2^32 points!");
+  }
+  index_ = index;
+  const std::uint64_t gray = index ^ (index >> 1);
+  for (std::size_t d = 0; d != dimension_; ++d) {
+    std::uint32_t x = 0;
+    for (std::size_t k = 0; k != numBits_; ++k) {
+      if ((gray >> k) & 1) {
+        x ^= directions_[d * numBits_ + k];
+      }
+    }
+    state_[d] = x;
+  }
+}
+
+void SobolSequence::next(std::span<Real> point) {
+  constexpr Real scale = 1.0 / 4294967296.0;
+  for (std::size_t d = 0; d != dimension_; ++d) {
+    std::uint32_t x = nestedUniformScramble(state_[d], scrambleSeeds_[d]);
+    point[d] = (static_cast<Real>(x) + 0.5) * scale;
+  }
+  // consecutive Gray codes differ in the lowest set bit of index_ + 1
+  const auto k = static_cast<std::size_t>(std::countr_zero(index_ + 1));
+  if (k < numBits_) {
+    for (std::size_t d = 0; d != dimension_; ++d) {
+      state_[d] ^= directions_[d * numBits_ + k];
+    }
+  }
+  ++index_;
+}
+
+// Acklam's rational approximation, good to about 1e-9, polished by one
+// Halley step on erfc to full double precision
+auto inverseNormalCdf(Real u) -> Real {
+  if (!(u > 0.0 && u < 1.0)) {
+    return std::numeric_limits<Real>::quiet_NaN();
+  }
+  constexpr Real a[] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                        -2.759285104469687e+02, 1.383577518672690e+02,
+                        -3.066479806614716e+01, 2.506628277459239e+00};
+  constexpr Real b[] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                        -1.556989798598866e+02, 6.680131188771972e+01,
+                        -1.328068155288572e+01};
+  constexpr Real c[] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                        -2.400758277161838e+00, -2.549732539343734e+00,
+                        4.374664141464968e+00,  2.938163982698783e+00};
+  constexpr Real d[] = {7.784695709041462e-03, 3.224671290700398e-01,
+                        2.445134137142996e+00, 3.754408661907416e+00};
+  constexpr Real low = 0.02425;
+
+  Real x;
+  if (u < low || u > 1.0 - low) {
+    Real q = std::sqrt(-2.0 * std::log(u < low ? u : 1.0 - u));
+    x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+        ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    x = u < low ? x : -x;
+  } else {
+    Real q = u - 0.5;
+    Real r = q * q;
+    x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) *
+        q /
+        (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+  }
+
+  // Phi(x) - u, taking the upper tail from 1 - u, which is exact for u > 1/2
+  Real e = u < 0.5 ? 0.5 * std::erfc(-x / std::numbers::sqrt2) - u
+                   : (1.0 - u) - 0.5 * std::erfc(x / std::numbers::sqrt2);
+  Real step = e * std::sqrt(2.0 * std::numbers::pi) * std::exp(x * x / 2);
+  return x - step / (1.0 + x * step / 2);
+}
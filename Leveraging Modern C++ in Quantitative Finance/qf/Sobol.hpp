@@ -0,0 +1,42 @@
+#ifndef QF_SOBOL_HPP
+#define QF_SOBOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+using Real = double;
+
+// Owen-scrambled Sobol sequence of 32-bit points in any number of
+// dimensions, visited in Gray-code order. The direction numbers are built at
+// construction: primitive polynomials over GF(2) are found by search, and
+// their initial direction numbers are drawn from a fixed Philox stream, so
+// no tables are needed. Each dimension is then scrambled with the hash-based
+// nested uniform permutation of Burley (JCGT 9(4), 2020) under scrambleSeed.
+class SobolSequence {
+public:
+  SobolSequence(std::size_t dimension, std::uint64_t scrambleSeed);
+
+  [[nodiscard]] auto dimension() const -> std::size_t;
+
+  // make point index the next one returned
+  void seek(std::uint64_t index);
+
+  // the next point as uniforms in (0, 1), one per dimension
+  void next(std::span<Real> point);
+
+private:
+  static constexpr std::size_t numBits_ = 32;
+
+  std::size_t dimension_;
+  std::vector<std::uint32_t> directions_; // numBits_ per dimension
+  std::vector<std::uint32_t> scrambleSeeds_;
+  std::vector<std::uint32_t> state_;
+  std::uint64_t index_;
+};
+
+// inverse of the standard normal distribution function on (0, 1)
+[[nodiscard]] auto inverseNormalCdf(Real u) -> Real;
+
+#endif // QF_SOBOL_HPP
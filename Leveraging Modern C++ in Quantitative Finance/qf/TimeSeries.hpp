@@ -1,43 +1,50 @@
-#ifndef QF_TIMESERIES_HPP
-#define QF_TIMESERIES_HPP
-
-#include <boost/circular_buffer.hpp>
-#include <vector>
-
-using Real = double;
-
-class TimeSeries {
-public:
-  explicit TimeSeries(std::size_t length);
-  explicit TimeSeries(boost::circular_buffer<Real> ts);
-  explicit TimeSeries(const std::vector<Real> &ts);
-
-  void append(Real x);
-  [[nodiscard]] auto value(std::size_t k) const -> Real;
-  [[nodiscard]] auto buffer() const -> boost::circular_buffer<Real>;
-
-  [[nodiscard]] auto movingAvg(std::size_t t = 0) const -> Real;
-  [[nodiscard]] auto volatility(std::size_t t = 0) const -> Real;
-
-private:
-  boost::circular_buffer<Real> ts_;
-  [[nodiscard]] auto mean_(std::size_t t = 0) const -> Real;
-};
-
-#endif // QF_TIMESERIES_HPP
-
-/*
-        Copyright 2019 Daniel Hanson
-
-        Licensed under the Apache License, Version 2.0 (the "License");
-        you may not use this file except in compliance with the License.
-        You may obtain a copy of the License at
-
-                http://www.apache.org/licenses/LICENSE-2.0
-
-        Unless required by applicable law or agreed to in writing, software
-        distributed under the License is distributed on an "AS IS" BASIS,
-        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-        See the License for the specific language governing permissions and
-        limitations under the License.
-*/
+#ifndef QF_TIMESERIES_HPP
+#define QF_TIMESERIES_HPP
+
+#include <boost/circular_buffer.hpp>
+#include <vector>
+
+using Real = double;
+
+// Fixed-length history of values of type T, e.g. float or double; the moving
+// average and volatility are accumulated in double whatever T is
+template <typename T> class BasicTimeSeries {
+public:
+  explicit BasicTimeSeries(std::size_t length);
+  explicit BasicTimeSeries(boost::circular_buffer<T> ts);
+  explicit BasicTimeSeries(const std::vector<T> &ts);
+
+  void append(T x);
+  [[nodiscard]] auto value(std::size_t k) const -> T;
+  [[nodiscard]] auto buffer() const -> boost::circular_buffer<T>;
+
+  [[nodiscard]] auto movingAvg(std::size_t t = 0) const -> T;
+  [[nodiscard]] auto volatility(std::size_t t = 0) const -> T;
+
+private:
+  boost::circular_buffer<T> ts_;
+  [[nodiscard]] auto mean_(std::size_t t = 0) const -> double;
+};
+
+extern template class BasicTimeSeries<float>;
+extern template class BasicTimeSeries<double>;
+
+using TimeSeries = BasicTimeSeries<Real>;
+
+#endif // QF_TIMESERIES_HPP
+
+/*
+        Copyright 2019 Daniel Hanson
+
+        Licensed under the Apache License, Version 2.0 (the "License");
+        you may not use this file except in compliance with the License.
+        You may obtain a copy of the License at
+
+                http://www.apache.org/licenses/LICENSE-2.0
+
+        Unless required by applicable law or agreed to in writing, software
+        distributed under the License is distributed on an "AS IS" BASIS,
+        WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+        See the License for the specific language governing permissions and
+        limitations under the License.
+*/